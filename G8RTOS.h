@@ -7,7 +7,15 @@
 
 #include <G8RTOS_Scheduler.h>
 #include <G8RTOS_Semaphores.h>
+#include <G8RTOS_Mutex.h>
+#include <G8RTOS_EventGroup.h>
+#include <G8RTOS_Notify.h>
 #include <G8RTOS_IPC.h>
+#include <G8RTOS_Pool.h>
+#include <G8RTOS_Timer.h>
+#include <G8RTOS_WorkQueue.h>
+#include <G8RTOS_Trace.h>
+#include <G8RTOS_IRQLatency.h>
 #include <stdint.h>
 
 #endif /* G8RTOS_H_ */
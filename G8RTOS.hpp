@@ -0,0 +1,210 @@
+/*
+ * G8RTOS.hpp
+ *
+ * Header-only C++ layer over the kernel objects
+ *      - g8::Queue<T, N>: typed message queue, element type and capacity are template parameters
+ *      - g8::Semaphore, g8::Mutex (with g8::LockGuard): the C objects with their functions as members
+ *      - g8::Thread<StackWords>: adds a thread whose stack size is checked at compile time
+ *      - Every object holds its own storage (no heap, no global slots), so there can be as many as the application declares
+ *      - Objects wrap kernel structures other threads point into, so they can neither be copied nor moved
+ */
+
+#ifndef G8RTOS_HPP_
+#define G8RTOS_HPP_
+
+/***************************************************** Includes ***********************************************************************/
+
+extern "C"
+{
+#include "G8RTOS.h"
+#include "G8RTOS_CriticalSection.h"
+}
+
+/***************************************************** Includes ***********************************************************************/
+
+namespace g8
+{
+
+/************************************************* Classes Used ***********************************************************************/
+
+/*
+ * Counting semaphore
+ *      - Timeouts are in milliseconds, 0 only tries, WAIT_FOREVER waits until the semaphore is taken
+ */
+class Semaphore
+{
+public:
+    explicit Semaphore(int32_t value = 0) { G8RTOS_InitSemaphore(&s_, value); }
+
+    void acquire() { G8RTOS_AcquireSemaphore(&s_); }
+    bool tryAcquire() { return G8RTOS_TryAcquireSemaphore(&s_) == 0; }
+    bool acquire(uint32_t timeout) { return G8RTOS_AcquireSemaphoreTimeout(&s_, timeout) == 0; }
+    void release() { G8RTOS_ReleaseSemaphore(&s_); }
+
+    int32_t count() const { return s_.count; }
+    semaphore_t * native() { return &s_; }
+
+private:
+    Semaphore(const Semaphore &);
+    Semaphore & operator=(const Semaphore &);
+
+    semaphore_t s_;
+};
+
+/*
+ * Recursive mutex with priority inheritance
+ */
+class Mutex
+{
+public:
+    Mutex() { G8RTOS_InitMutex(&m_); }
+
+    void lock() { G8RTOS_LockMutex(&m_); }
+    bool unlock() { return G8RTOS_UnlockMutex(&m_) == 0; }
+
+    mutex_t * native() { return &m_; }
+
+private:
+    Mutex(const Mutex &);
+    Mutex & operator=(const Mutex &);
+
+    mutex_t m_;
+};
+
+/*
+ * Locks a mutex for the lifetime of the guard
+ */
+class LockGuard
+{
+public:
+    explicit LockGuard(Mutex & m) : m_(m) { m_.lock(); }
+    ~LockGuard() { m_.unlock(); }
+
+private:
+    LockGuard(const LockGuard &);
+    LockGuard & operator=(const LockGuard &);
+
+    Mutex & m_;
+};
+
+/*
+ * Typed message queue
+ *      - Ring of N elements of type T inside the object, T is copied in and out (meant for small structs)
+ *      - items counts the queued elements, spaces the free slots, so send blocks while full and receive while empty
+ *      - Any number of senders and receivers, the slot indices are advanced inside a critical section
+ *      - Slot indices wrap with a mask when N is a power of 2, with a compare otherwise (chosen at compile time)
+ *      - trySend/tryReceive never block and can be called from ISRs
+ */
+template <typename T, uint32_t N>
+class Queue
+{
+public:
+    Queue() : head_(0), tail_(0), items_(0), spaces_((int32_t)N) {}
+
+    /*
+     * Sends a copy of item, waiting at most timeout ms for a free slot
+     * Returns: true if item was queued
+     */
+    bool send(const T & item, uint32_t timeout = WAIT_FOREVER)
+    {
+        if (!spaces_.tryAcquire() && (timeout == 0 || !spaces_.acquire(timeout)))
+        {
+            return false;
+        }
+        uint32_t savedmask = StartCriticalSection();
+        buffer_[tail_] = item;
+        tail_ = Next(tail_);
+        EndCriticalSection(savedmask);
+        items_.release();
+        return true;
+    }
+
+    /*
+     * Receives the oldest element into item, waiting at most timeout ms for one
+     * Returns: true if item was written
+     */
+    bool receive(T & item, uint32_t timeout = WAIT_FOREVER)
+    {
+        if (!items_.tryAcquire() && (timeout == 0 || !items_.acquire(timeout)))
+        {
+            return false;
+        }
+        uint32_t savedmask = StartCriticalSection();
+        item = buffer_[head_];
+        head_ = Next(head_);
+        EndCriticalSection(savedmask);
+        spaces_.release();
+        return true;
+    }
+
+    bool trySend(const T & item) { return send(item, 0); }
+    bool tryReceive(T & item) { return receive(item, 0); }
+
+    uint32_t size() const { int32_t n = items_.count(); return n > 0 ? (uint32_t)n : 0; }
+    bool empty() const { return size() == 0; }
+    static uint32_t capacity() { return N; }
+
+private:
+    Queue(const Queue &);
+    Queue & operator=(const Queue &);
+
+    static_assert(N > 0, "g8::Queue needs at least one slot");
+    static_assert(N <= 0x7FFFFFFF, "g8::Queue capacity must fit a semaphore count");
+
+    static constexpr bool kPowerOfTwo = (N & (N - 1)) == 0;
+
+    static constexpr uint32_t Next(uint32_t index)
+    {
+        return kPowerOfTwo ? ((index + 1) & (N - 1)) : (index + 1 == N ? 0 : index + 1);
+    }
+
+    T buffer_[N];
+    uint32_t head_;
+    uint32_t tail_;
+    Semaphore items_;
+    Semaphore spaces_;
+};
+
+/*
+ * Thread with a StackWords word stack
+ *      - The stack is taken from the kernel's stack arena like G8RTOS_AddThreadStack does, its size is checked at compile time
+ *      - Threads do not get an argument, so the entry is a plain function, as for the C API
+ */
+template <uint32_t StackWords = STACKSIZE>
+class Thread
+{
+public:
+    static_assert(StackWords >= MIN_STACKSIZE, "g8::Thread stack is smaller than MIN_STACKSIZE");
+    static_assert(StackWords + 2 <= STACK_ARENA_WORDS, "g8::Thread stack does not fit in the stack arena");
+
+    static const uint32_t stackWords = StackWords;
+
+    /*
+     * Adds the thread to the scheduler
+     * Returns: NO_ERROR, or the G8RTOS_AddThreadStack error
+     */
+    static sched_ErrCode_t start(void (*entry)(void), uint8_t priority, const char * name)
+    {
+        return G8RTOS_AddThreadStack(entry, priority, const_cast<char *>(name), StackWords);
+    }
+};
+
+/************************************************* Classes Used ***********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Calls on the running thread
+ */
+namespace this_thread
+{
+    inline threadId_t id() { return G8RTOS_GetThreadID(); }
+    inline void sleep(uint32_t ms) { G8RTOS_Sleep(ms); }
+    inline void yield() { G8RTOS_Yield(); }
+}
+
+/*********************************************** Public Functions *********************************************************************/
+
+} // namespace g8
+
+#endif /* G8RTOS_HPP_ */
@@ -0,0 +1,681 @@
+/*
+ * G8RTOS_Benchmark.c
+ */
+
+/***************************************************** Includes ***********************************************************************/
+
+#include <stdio.h>
+#include <G8RTOS.h>
+#include "G8RTOS_Benchmark.h"
+#include "G8RTOS_Structures.h"
+
+/***************************************************** Includes ***********************************************************************/
+
+/*************************************************** Defines Used *********************************************************************/
+
+#define BENCHMARK_LONG_SLEEP 1000000            // milliseconds, sleeping helpers never wake up during a measurement
+
+/*************************************************** Defines Used *********************************************************************/
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*
+ * IDs of the helper threads to kill after a measurement
+ */
+static threadId_t helperIDs[MAX_THREADS];
+static uint32_t numberOfHelpers;
+
+/*
+ * Helpers wait on benchStart before the timed part and signal benchDone after it
+ * Helpers that are done (or only there to be counted) wait on benchParked until they are killed
+ */
+static semaphore_t benchStart;
+static semaphore_t benchDone;
+static semaphore_t benchParked;
+static semaphore_t benchPing;
+static semaphore_t benchPong;
+
+/*
+ * Lock shared by the priority inversion helpers, a semaphore initialized to 1 or a mutex
+ */
+static semaphore_t benchLockSemaphore;
+static mutex_t benchLockMutex;
+static bool benchUseMutex;
+
+/*
+ * Seed of the next FPU yield helper and number of FPU helpers that ended with a wrong result
+ */
+static float benchFPUSeed;
+static volatile uint32_t benchFPUErrors;
+
+/*
+ * Longest time the high priority inversion helper waited for the lock
+ */
+static uint32_t benchWorstBlocking;
+
+/*
+ * Thread IDs of the notification ping/pong helpers, each notifies the other
+ */
+static threadId_t benchPingID;
+static threadId_t benchPongID;
+
+/*
+ * Shared operation counter of the running measurement
+ */
+static volatile uint32_t benchCount;
+
+/*
+ * Priority of the thread running the benchmarks, helpers run at the same priority
+ */
+static uint8_t benchPriority;
+
+/*
+ * Output function given to G8RTOS_RunBenchmarks
+ */
+static void (*Print)(const char * line);
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Records the calling helper's ID so it can be killed after the measurement
+ */
+static void RegisterHelper(void)
+{
+    uint32_t savedmask = StartCriticalSection();
+    helperIDs[numberOfHelpers++] = G8RTOS_GetThreadID();
+    EndCriticalSection(savedmask);
+}
+
+/*
+ * Helper that only adds to the number of threads, blocked the whole time
+ */
+static void ParkedThread(void)
+{
+    RegisterHelper();
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * Helper that only adds to the number of threads, asleep the whole time
+ */
+static void SleepingThread(void)
+{
+    RegisterHelper();
+    G8RTOS_Sleep(BENCHMARK_LONG_SLEEP);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * Yields to the other yield helper until BENCHMARK_ITERATIONS yields have been done between them
+ */
+static void YieldThread(void)
+{
+    RegisterHelper();
+    G8RTOS_AcquireSemaphore(&benchStart);
+    while (benchCount < BENCHMARK_ITERATIONS)
+    {
+        benchCount++;
+        G8RTOS_Yield();
+    }
+    G8RTOS_ReleaseSemaphore(&benchDone);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * One step of the FPU helpers' float computation, uses caller and callee saved FPU registers
+ */
+static float FPUStep(float x)
+{
+    return x * 1.0001f + 0.5f / (x + 1.0f);
+}
+
+/*
+ * Returns the result of BENCHMARK_ITERATIONS / 2 FPU steps from a seed
+ */
+static float FPUResult(float seed)
+{
+    float x = seed;
+    for (uint32_t i = 0; i < BENCHMARK_ITERATIONS / 2; i++)
+    {
+        x = FPUStep(x);
+    }
+    return x;
+}
+
+/*
+ * Like YieldThread, but keeps float values in FPU registers across every yield and checks the result at the end
+ */
+static void FPUYieldThread(void)
+{
+    RegisterHelper();
+    float seed = benchFPUSeed;
+    benchFPUSeed += 1.0f;
+    float expected = FPUResult(seed);
+
+    G8RTOS_AcquireSemaphore(&benchStart);
+    float x = seed;
+    for (uint32_t i = 0; i < BENCHMARK_ITERATIONS / 2; i++)
+    {
+        x = FPUStep(x);
+        benchCount++;
+        G8RTOS_Yield();
+    }
+    if (x != expected)
+    {
+        benchFPUErrors++;
+    }
+    G8RTOS_ReleaseSemaphore(&benchDone);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * Starts every round trip by signalling benchPing and waits for the answer on benchPong
+ */
+static void PingThread(void)
+{
+    RegisterHelper();
+    G8RTOS_AcquireSemaphore(&benchStart);
+    for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        G8RTOS_ReleaseSemaphore(&benchPing);
+        G8RTOS_AcquireSemaphore(&benchPong);
+    }
+    G8RTOS_ReleaseSemaphore(&benchDone);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * Answers every benchPing with a benchPong
+ */
+static void PongThread(void)
+{
+    RegisterHelper();
+    G8RTOS_AcquireSemaphore(&benchStart);
+    for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        G8RTOS_AcquireSemaphore(&benchPing);
+        G8RTOS_ReleaseSemaphore(&benchPong);
+    }
+    G8RTOS_ReleaseSemaphore(&benchDone);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * Starts every round trip by notifying the pong helper and waits to be notified back
+ */
+static void NotifyPingThread(void)
+{
+    RegisterHelper();
+    benchPingID = G8RTOS_GetThreadID();
+    G8RTOS_AcquireSemaphore(&benchStart);
+    for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        G8RTOS_Notify(benchPongID, 0, NOTIFY_INCREMENT);
+        G8RTOS_NotifyWait(0xFFFFFFFF, 0, WAIT_FOREVER);
+    }
+    G8RTOS_ReleaseSemaphore(&benchDone);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * Answers every notification with one to the ping helper
+ */
+static void NotifyPongThread(void)
+{
+    RegisterHelper();
+    benchPongID = G8RTOS_GetThreadID();
+    G8RTOS_AcquireSemaphore(&benchStart);
+    for (uint32_t i = 0; i < BENCHMARK_ITERATIONS; i++)
+    {
+        G8RTOS_NotifyWait(0xFFFFFFFF, 0, WAIT_FOREVER);
+        G8RTOS_Notify(benchPingID, 0, NOTIFY_INCREMENT);
+    }
+    G8RTOS_ReleaseSemaphore(&benchDone);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * Writes to BENCHMARK_FIFO until the reader has read BENCHMARK_ITERATIONS words
+ *  - Yields every half FIFO so the reader empties it before it overflows
+ */
+static void FIFOWriterThread(void)
+{
+    RegisterHelper();
+    G8RTOS_AcquireSemaphore(&benchStart);
+    for (uint32_t i = 0; benchCount < BENCHMARK_ITERATIONS; i++)
+    {
+        G8RTOS_WriteFIFO(BENCHMARK_FIFO, i);
+        if ((i % (MAX_FIFO_SIZE / 2)) == (MAX_FIFO_SIZE / 2) - 1)
+        {
+            G8RTOS_Yield();
+        }
+    }
+    G8RTOS_ReleaseSemaphore(&benchDone);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * Reads BENCHMARK_ITERATIONS words from BENCHMARK_FIFO
+ */
+static void FIFOReaderThread(void)
+{
+    RegisterHelper();
+    G8RTOS_AcquireSemaphore(&benchStart);
+    while (benchCount < BENCHMARK_ITERATIONS)
+    {
+        G8RTOS_ReadFIFO(BENCHMARK_FIFO);
+        benchCount++;
+    }
+    G8RTOS_ReleaseSemaphore(&benchDone);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * Writes to BENCHMARK_FIFO in batches of half a FIFO until the reader has read BENCHMARK_ITERATIONS words
+ */
+static void FIFOBatchWriterThread(void)
+{
+    int32_t batch[MAX_FIFO_SIZE / 2] = {0};
+    RegisterHelper();
+    G8RTOS_AcquireSemaphore(&benchStart);
+    while (benchCount < BENCHMARK_ITERATIONS)
+    {
+        G8RTOS_WriteFIFOBatch(BENCHMARK_FIFO, batch, MAX_FIFO_SIZE / 2);
+        G8RTOS_Yield();
+    }
+    G8RTOS_ReleaseSemaphore(&benchDone);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * Reads BENCHMARK_ITERATIONS words from BENCHMARK_FIFO, as many as are available per call
+ */
+static void FIFOBatchReaderThread(void)
+{
+    int32_t batch[MAX_FIFO_SIZE];
+    RegisterHelper();
+    G8RTOS_AcquireSemaphore(&benchStart);
+    while (benchCount < BENCHMARK_ITERATIONS)
+    {
+        benchCount += G8RTOS_ReadFIFOBatch(BENCHMARK_FIFO, batch, MAX_FIFO_SIZE);
+    }
+    G8RTOS_ReleaseSemaphore(&benchDone);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * Locks the inversion benchmark's lock
+ */
+static void InversionLock(void)
+{
+    if (benchUseMutex)
+    {
+        G8RTOS_LockMutex(&benchLockMutex);
+    }
+    else
+    {
+        G8RTOS_AcquireSemaphore(&benchLockSemaphore);
+    }
+}
+
+/*
+ * Unlocks the inversion benchmark's lock
+ */
+static void InversionUnlock(void)
+{
+    if (benchUseMutex)
+    {
+        G8RTOS_UnlockMutex(&benchLockMutex);
+    }
+    else
+    {
+        G8RTOS_ReleaseSemaphore(&benchLockSemaphore);
+    }
+}
+
+/*
+ * Spins for a number of microseconds without blocking
+ */
+static void BusyWait(uint32_t microseconds)
+{
+    uint32_t cycles = (uint32_t)((uint64_t)G8RTOS_PortCyclesPerSecond() * microseconds / 1000000);
+    uint32_t start = G8RTOS_PortGetCycles();
+    while (G8RTOS_PortGetCycles() - start < cycles);
+}
+
+/*
+ * Low priority inversion helper: locks, wakes the high then the medium priority helper and finishes a short critical section
+ */
+static void InversionLowThread(void)
+{
+    RegisterHelper();
+    G8RTOS_AcquireSemaphore(&benchStart);
+    for (uint32_t i = 0; i < BENCHMARK_INVERSION_ROUNDS; i++)
+    {
+        InversionLock();
+        G8RTOS_ReleaseSemaphore(&benchPing);
+        G8RTOS_Yield();                                 // high priority helper runs and blocks on the lock
+        G8RTOS_ReleaseSemaphore(&benchPong);
+        G8RTOS_Yield();                                 // medium priority helper preempts, unless the lock raised this thread above it
+        BusyWait(BENCHMARK_INVERSION_CRITICAL_US);
+        InversionUnlock();
+    }
+    G8RTOS_ReleaseSemaphore(&benchDone);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * Medium priority inversion helper: unrelated CPU bound work that does not use the lock
+ */
+static void InversionMediumThread(void)
+{
+    RegisterHelper();
+    G8RTOS_AcquireSemaphore(&benchStart);
+    for (uint32_t i = 0; i < BENCHMARK_INVERSION_ROUNDS; i++)
+    {
+        G8RTOS_AcquireSemaphore(&benchPong);
+        BusyWait(BENCHMARK_INVERSION_BUSY_US);
+    }
+    G8RTOS_ReleaseSemaphore(&benchDone);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * High priority inversion helper: measures how long it waits for the lock held by the low priority helper
+ */
+static void InversionHighThread(void)
+{
+    RegisterHelper();
+    G8RTOS_AcquireSemaphore(&benchStart);
+    for (uint32_t i = 0; i < BENCHMARK_INVERSION_ROUNDS; i++)
+    {
+        G8RTOS_AcquireSemaphore(&benchPing);
+        uint32_t start = G8RTOS_PortGetCycles();
+        InversionLock();
+        uint32_t blocking = G8RTOS_PortGetCycles() - start;
+        InversionUnlock();
+        if (blocking > benchWorstBlocking)
+        {
+            benchWorstBlocking = blocking;
+        }
+    }
+    G8RTOS_ReleaseSemaphore(&benchDone);
+    G8RTOS_AcquireSemaphore(&benchParked);
+}
+
+/*
+ * Empty periodic thread, only there to be counted by the tick benchmark
+ */
+static void BenchmarkPeriodicThread(void)
+{
+}
+
+/*
+ * Resets the semaphores and counter used by one measurement
+ */
+static void ResetMeasurement(void)
+{
+    G8RTOS_InitSemaphore(&benchStart, 0);
+    G8RTOS_InitSemaphore(&benchDone, 0);
+    G8RTOS_InitSemaphore(&benchParked, 0);
+    G8RTOS_InitSemaphore(&benchPing, 0);
+    G8RTOS_InitSemaphore(&benchPong, 0);
+    G8RTOS_InitSemaphore(&benchLockSemaphore, 1);
+    G8RTOS_InitMutex(&benchLockMutex);
+    benchCount = 0;
+    benchWorstBlocking = 0;
+}
+
+/*
+ * Adds helper threads with stacks of stackWords words and lets them run up to their first wait
+ *  - Sleeps until every added helper has registered, a single sleep is not enough: the tick that wakes the caller
+ *    also rotates its ready list, which can put the caller ahead of a helper that has not run yet
+ *  - An unregistered helper would never be killed and would be left waiting on a semaphore the next measurement re-initializes
+ * Returns: Number of helpers that could be added
+ */
+static uint32_t AddHelpersStack(void (*helper)(void), uint32_t count, uint8_t priority, uint32_t stackWords)
+{
+    uint32_t registered = numberOfHelpers;
+    uint32_t added = 0;
+    while (added < count && G8RTOS_AddThreadStack(helper, priority, "bench", stackWords) == NO_ERROR)
+    {
+        added++;
+    }
+    do
+    {
+        G8RTOS_Sleep(1);
+    } while (numberOfHelpers < registered + added);
+    return added;
+}
+
+/*
+ * Adds helper threads with STACKSIZE stacks, see AddHelpersStack
+ */
+static uint32_t AddHelpers(void (*helper)(void), uint32_t count, uint8_t priority)
+{
+    return AddHelpersStack(helper, count, priority, STACKSIZE);
+}
+
+/*
+ * Kills every registered helper thread
+ */
+static void KillHelpers(void)
+{
+    for (uint32_t i = 0; i < numberOfHelpers; i++)
+    {
+        G8RTOS_KillThread(helperIDs[i]);
+    }
+    numberOfHelpers = 0;
+}
+
+/*
+ * Lets waiting helpers start and waits until they are all done
+ * Returns: Cycles from the start signal until the last helper is done
+ */
+static uint32_t RunHelpers(uint32_t count)
+{
+    uint32_t start = G8RTOS_PortGetCycles();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        G8RTOS_ReleaseSemaphore(&benchStart);
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        G8RTOS_AcquireSemaphore(&benchDone);
+    }
+    return G8RTOS_PortGetCycles() - start;
+}
+
+/*
+ * Calls SysTick_Handler BENCHMARK_TICKS times with interrupts disabled
+ * Returns: Cycles for all calls
+ */
+static uint32_t TimeTicks(void)
+{
+    uint32_t savedmask = StartCriticalSection();
+    uint32_t start = G8RTOS_PortGetCycles();
+    for (uint32_t i = 0; i < BENCHMARK_TICKS; i++)
+    {
+        SysTick_Handler();
+    }
+    uint32_t cycles = G8RTOS_PortGetCycles() - start;
+    EndCriticalSection(savedmask);
+    return cycles;
+}
+
+/*
+ * Prints one CSV result line
+ */
+static void PrintResult(const char * benchmark, uint32_t periodicThreads, uint32_t iterations, uint32_t cycles)
+{
+    char line[128];
+    uint32_t opsPerSecond = cycles ? (uint32_t)((uint64_t)iterations * G8RTOS_PortCyclesPerSecond() / cycles) : 0;
+    snprintf(line, sizeof(line), "%s,%lu,%lu,%lu,%lu,%lu,%lu", benchmark,
+             (unsigned long)G8RTOS_GetNumberOfThreads(), (unsigned long)periodicThreads, (unsigned long)iterations,
+             (unsigned long)cycles, (unsigned long)(iterations ? cycles / iterations : 0), (unsigned long)opsPerSecond);
+    Print(line);
+}
+
+#if defined(G8RTOS_PORT_POSIX)
+/*
+ * Sleeps for BENCHMARK_TICK_RATE_MS and prints the tick interrupts delivered meanwhile
+ *  - The cycles reported are the simulated time that passed (SystemTime), so ops_per_second is tick interrupts per simulated second
+ */
+static void PrintTickRate(uint32_t periodicThreads)
+{
+    uint32_t savedmask = StartCriticalSection();
+    uint32_t startTime = SystemTime;
+    uint32_t startInterrupts = G8RTOS_PortTickInterrupts();
+    EndCriticalSection(savedmask);
+
+    G8RTOS_Sleep(BENCHMARK_TICK_RATE_MS);
+
+    savedmask = StartCriticalSection();
+    uint32_t elapsed = SystemTime - startTime;
+    uint32_t interrupts = G8RTOS_PortTickInterrupts() - startInterrupts;
+    EndCriticalSection(savedmask);
+
+    PrintResult("tick_interrupts", periodicThreads, interrupts, (uint32_t)((uint64_t)elapsed * G8RTOS_PortCyclesPerSecond() / 1000));
+}
+#endif
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+void G8RTOS_RunBenchmarks(void (*print)(const char * line))
+{
+    Print = print;
+    benchPriority = CurrentlyRunningThread->priority;
+    numberOfHelpers = 0;
+
+    Print("benchmark,threads,periodic,iterations,cycles,cycles_per_op,ops_per_second");
+
+    // YIELD - two yielding threads, plus more and more blocked threads the scheduler must not be slowed down by,
+    //         the last measurement fills every thread slot left (parked threads get the smallest stack so the arena is not the limit)
+    for (uint32_t parked = 0; ; parked += BENCHMARK_THREAD_STEP)
+    {
+        ResetMeasurement();
+        if (AddHelpers(YieldThread, 2, benchPriority) != 2)
+        {
+            KillHelpers();
+            break;
+        }
+        bool full = AddHelpersStack(ParkedThread, parked, benchPriority, MIN_STACKSIZE) != parked;
+        uint32_t cycles = RunHelpers(2);
+        PrintResult("yield", 0, BENCHMARK_ITERATIONS, cycles);
+        KillHelpers();
+        if (full)
+        {
+            break;
+        }
+    }
+
+    // YIELD FPU - the same with two threads that keep float values in FPU registers, so every switch saves and restores FPU context
+    ResetMeasurement();
+    benchFPUSeed = 1.0f;
+    benchFPUErrors = 0;
+    AddHelpers(FPUYieldThread, 2, benchPriority);
+    uint32_t fpuCycles = RunHelpers(2);
+    PrintResult(benchFPUErrors ? "yield_fpu_corrupted" : "yield_fpu", 0, BENCHMARK_ITERATIONS, fpuCycles);
+    KillHelpers();
+
+    // SEMAPHORE - release/acquire round trips between two threads
+    ResetMeasurement();
+    AddHelpers(PingThread, 1, benchPriority);
+    AddHelpers(PongThread, 1, benchPriority);
+    PrintResult("semaphore", 0, BENCHMARK_ITERATIONS, RunHelpers(2));
+    KillHelpers();
+
+    // NOTIFY - the same round trips with direct-to-thread notifications instead of two semaphores
+    ResetMeasurement();
+    AddHelpers(NotifyPingThread, 1, benchPriority);
+    AddHelpers(NotifyPongThread, 1, benchPriority);
+    PrintResult("notify", 0, BENCHMARK_ITERATIONS, RunHelpers(2));
+    KillHelpers();
+
+    // FIFO - words through a FIFO from a writer to a reader thread
+    ResetMeasurement();
+    G8RTOS_InitFIFO(BENCHMARK_FIFO);
+    AddHelpers(FIFOWriterThread, 1, benchPriority);
+    AddHelpers(FIFOReaderThread, 1, benchPriority);
+    PrintResult("fifo", 0, BENCHMARK_ITERATIONS, RunHelpers(2));
+    KillHelpers();
+
+    // FIFO SPSC - the same words through the FIFO in single producer/single consumer mode
+    ResetMeasurement();
+    G8RTOS_InitFIFOSPSC(BENCHMARK_FIFO, 1);
+    AddHelpers(FIFOWriterThread, 1, benchPriority);
+    AddHelpers(FIFOReaderThread, 1, benchPriority);
+    PrintResult("fifo_spsc", 0, BENCHMARK_ITERATIONS, RunHelpers(2));
+    KillHelpers();
+
+    // FIFO BATCH - half a FIFO per write, everything available per read, in SPSC mode
+    ResetMeasurement();
+    G8RTOS_InitFIFOSPSC(BENCHMARK_FIFO, 1);
+    AddHelpers(FIFOBatchWriterThread, 1, benchPriority);
+    AddHelpers(FIFOBatchReaderThread, 1, benchPriority);
+    PrintResult("fifo_batch", 0, BENCHMARK_ITERATIONS, RunHelpers(2));
+    KillHelpers();
+
+    // INVERSION - worst case lock wait of a high priority thread while a medium priority thread keeps the low priority owner from running
+    if (benchPriority + 3 < IDLE_THREAD_PRIORITY)
+    {
+        for (uint32_t useMutex = 0; useMutex < 2; useMutex++)
+        {
+            ResetMeasurement();
+            benchUseMutex = useMutex;
+            AddHelpers(InversionHighThread, 1, benchPriority + 1);
+            AddHelpers(InversionMediumThread, 1, benchPriority + 2);
+            AddHelpers(InversionLowThread, 1, benchPriority + 3);
+            RunHelpers(3);
+            PrintResult(useMutex ? "inversion_mutex" : "inversion_semaphore", 0, 1, benchWorstBlocking);
+            KillHelpers();
+        }
+    }
+
+    // TICK - SysTick_Handler with more and more sleeping threads
+    for (uint32_t sleeping = 0; ; sleeping += BENCHMARK_THREAD_STEP)
+    {
+        ResetMeasurement();
+        if (AddHelpers(SleepingThread, sleeping, benchPriority) != sleeping)
+        {
+            KillHelpers();
+            break;
+        }
+        PrintResult("tick", 0, BENCHMARK_TICKS, TimeTicks());
+        KillHelpers();
+    }
+
+    // TICK - SysTick_Handler with more and more periodic threads (never due during the measurement)
+    uint32_t periodic = 0;
+    while (1)
+    {
+        PrintResult("tick", periodic, BENCHMARK_TICKS, TimeTicks());
+        if (G8RTOS_AddPeriodicThreadOffset(BenchmarkPeriodicThread, BENCHMARK_LONG_SLEEP, BENCHMARK_LONG_SLEEP) != 0)
+        {
+            break;
+        }
+        periodic++;
+    }
+
+    while (periodic--)
+    {
+        G8RTOS_RemovePeriodicThread(BenchmarkPeriodicThread);
+    }
+
+#if defined(G8RTOS_PORT_POSIX)
+    // TICK INTERRUPTS - tick interrupts per simulated second while every thread sleeps, then with a periodic thread due every
+    // BENCHMARK_TICK_RATE_PERIOD ms (1000 per second without TICKLESS_IDLE, fewer with it)
+    PrintTickRate(0);
+    if (G8RTOS_AddPeriodicThread(BenchmarkPeriodicThread, BENCHMARK_TICK_RATE_PERIOD) == 0)
+    {
+        PrintTickRate(1);
+        G8RTOS_RemovePeriodicThread(BenchmarkPeriodicThread);
+    }
+#endif
+}
+
+/*********************************************** Public Functions *********************************************************************/
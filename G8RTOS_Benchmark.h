@@ -0,0 +1,65 @@
+/*
+ * G8RTOS_Benchmark.h
+ *
+ * Kernel micro-benchmarks, timed with G8RTOS_PortGetCycles (DWT CYCCNT on target, nanoseconds on the POSIX host)
+ *      - Only host numbers exist so far (build/g8bench on the POSIX port): they are nanoseconds of the Linux monotonic clock and
+ *        include the signal and ucontext overhead of the host port, so they compare changes but are not target cycle counts
+ *      - Target cycle counts need a run on the MSP432, no run under QEMU (mps2-an386) has been done
+ */
+
+#ifndef G8RTOS_BENCHMARK_H_
+#define G8RTOS_BENCHMARK_H_
+
+/***************************************************** Includes ***********************************************************************/
+
+#include <G8RTOS.h>
+
+/***************************************************** Includes ***********************************************************************/
+
+/*************************************************** Defines Used *********************************************************************/
+
+#define BENCHMARK_ITERATIONS 1000               // operations timed per measurement
+#define BENCHMARK_TICKS 1000                    // SysTick_Handler calls timed per measurement
+#define BENCHMARK_THREAD_STEP 6                 // extra threads added between two thread count measurements
+#define BENCHMARK_FIFO (MAX_FIFOS - 1)          // FIFO used (and re-initialized) by the FIFO benchmark
+#define BENCHMARK_INVERSION_ROUNDS 10           // lock waits measured per priority inversion measurement
+#define BENCHMARK_INVERSION_CRITICAL_US 100     // time the low priority thread holds the lock for
+#define BENCHMARK_INVERSION_BUSY_US 2000        // time the medium priority thread keeps the CPU for
+#define BENCHMARK_TICK_RATE_MS 1000             // simulated time the tick interrupts are counted over (POSIX host)
+#define BENCHMARK_TICK_RATE_PERIOD 10           // ms, period of the periodic thread during the second count
+
+/*************************************************** Defines Used *********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Runs every kernel benchmark and reports the results as CSV, starting with a header line
+ *      - yield:     G8RTOS_Yield + context switch between two threads, repeated for a growing number of blocked threads, from
+ *                   4 alive threads (the two yielders, the caller and the idle thread) up to MAX_THREADS
+ *      - yield_fpu: the same between two threads that use the FPU (reported as yield_fpu_corrupted if a thread's float result
+ *                   came out wrong, i.e. FPU registers were not preserved across context switches)
+ *      - semaphore: G8RTOS_ReleaseSemaphore/G8RTOS_AcquireSemaphore round trip between two threads
+ *      - notify:    G8RTOS_Notify/G8RTOS_NotifyWait round trip between two threads, to compare with semaphore
+ *      - fifo:      G8RTOS_WriteFIFO -> G8RTOS_ReadFIFO words per second between two threads
+ *      - fifo_spsc: the same with the FIFO in single producer/single consumer mode
+ *      - fifo_batch: G8RTOS_WriteFIFOBatch (half a FIFO) -> G8RTOS_ReadFIFOBatch words per second in SPSC mode
+ *      - inversion: worst case time a high priority thread waits for a lock held by a low priority thread while a medium priority
+ *                   thread is busy, with a semaphore as the lock (unbounded inversion) and then with a mutex (priority inheritance).
+ *                   Reported as a single iteration whose cycles are the worst wait over BENCHMARK_INVERSION_ROUNDS rounds
+ *      - tick:      SysTick_Handler cost for a growing number of sleeping threads, then of periodic threads
+ *      - tick_interrupts: POSIX host only, tick interrupts delivered while the caller sleeps for BENCHMARK_TICK_RATE_MS, with no
+ *                   periodic thread and then with one due every BENCHMARK_TICK_RATE_PERIOD ms. Cycles are the simulated time that
+ *                   passed, so ops_per_second is tick interrupts per simulated second (1000 without TICKLESS_IDLE)
+ * Columns: benchmark, alive threads, periodic threads added, iterations, total cycles, cycles per operation, operations per second
+ *
+ * NOTE: must be called from a thread after G8RTOS_Launch, with no other application thread ready at the same or higher priority.
+ *       Helper threads run at the caller's priority (the inversion helpers at the three priorities below it, priority numbers
+ *       caller + 1 to caller + 3, which ready application threads must not use either) and are killed afterwards.
+ *       The tick benchmark calls SysTick_Handler directly, so SystemTime runs ahead by BENCHMARK_TICKS for every tick measurement.
+ * Param "print": Called with each CSV line (no line ending)
+ */
+void G8RTOS_RunBenchmarks(void (*print)(const char * line));
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_BENCHMARK_H_ */
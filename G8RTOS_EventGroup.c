@@ -0,0 +1,158 @@
+/*
+ * G8RTOS_EventGroup.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "G8RTOS_EventGroup.h"
+#include "G8RTOS_Port.h"
+#include "G8RTOS_Scheduler.h"
+#include "G8RTOS_Structures.h"
+#include "G8RTOS_IRQLatency.h"
+
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Returns true if a wait for the given bits with the given options is satisfied by the group's bits
+ */
+static bool EventWaitSatisfied(uint32_t groupBits, uint32_t bits, uint8_t options)
+{
+    if (options & EVENT_WAIT_ALL)
+    {
+        return (groupBits & bits) == bits;
+    }
+    return (groupBits & bits) != 0;
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes an event group with every bit clear
+ * Param "g": Pointer to event group
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_InitEventGroup(eventGroup_t *g)
+{
+    uint32_t savedmask = StartCriticalSection();
+    g->wait.waiters = 0;
+    g->wait.type = WAIT_EVENT_GROUP;
+    g->bits = 0;
+    EndCriticalSection(savedmask);
+}
+
+/*
+ * Sets bits of an event group
+ *  - Walks the whole wait list, since each waiter waits for its own bits
+ *  - Woken threads get the group's bits in eventBits and are made ready
+ *  - Triggers a context switch if a thread was woken
+ * THIS IS A CRITICAL SECTION
+ */
+uint32_t G8RTOS_SetEventBits(eventGroup_t *g, uint32_t bits)
+{
+    uint32_t savedmask = StartCriticalSection();
+
+    g->bits |= bits;
+    uint32_t groupBits = g->bits;
+    uint32_t clearBits = 0;
+    bool woken = false;
+
+    tcb_t ** waiter = &g->wait.waiters;
+    while (*waiter)
+    {
+        tcb_t * pt = *waiter;
+        if (EventWaitSatisfied(groupBits, pt->eventBits, pt->eventOptions))
+        {
+            if (pt->eventOptions & EVENT_CLEAR_ON_EXIT)
+            {
+                clearBits |= pt->eventBits;
+            }
+            *waiter = pt->waitNext;             // unlink, *waiter is the next waiter now
+            pt->waitNext = 0;
+            pt->eventBits = groupBits;
+            pt->blocked = 0;
+            G8RTOS_AddToReadyList(pt);
+            G8RTOS_IRQ_LATENCY_WAKE(pt);
+            woken = true;
+        }
+        else
+        {
+            waiter = &pt->waitNext;
+        }
+    }
+
+    g->bits &= ~clearBits;
+    groupBits = g->bits;
+    EndCriticalSection(savedmask);
+
+    if (woken)
+    {
+        G8RTOS_Yield();
+    }
+    return groupBits;
+}
+
+/*
+ * Clears bits of an event group
+ * THIS IS A CRITICAL SECTION
+ */
+uint32_t G8RTOS_ClearEventBits(eventGroup_t *g, uint32_t bits)
+{
+    uint32_t savedmask = StartCriticalSection();
+    uint32_t groupBits = g->bits;
+    g->bits &= ~bits;
+    EndCriticalSection(savedmask);
+    return groupBits;
+}
+
+/*
+ * Returns the bits of an event group
+ */
+uint32_t G8RTOS_GetEventBits(eventGroup_t *g)
+{
+    return g->bits;
+}
+
+/*
+ * Waits until any or all of the given bits of an event group are set
+ *  - If the wait is not satisfied yet, blocks the thread in the group's wait list (ordered by priority) with the bits and
+ *    options in its tcb, G8RTOS_SetEventBits ends the wait
+ * THIS IS A CRITICAL SECTION
+ */
+uint32_t G8RTOS_WaitEventBits(eventGroup_t *g, uint32_t bits, uint8_t options)
+{
+    uint32_t savedmask = StartCriticalSection();
+
+    uint32_t groupBits = g->bits;
+    if (EventWaitSatisfied(groupBits, bits, options))
+    {
+        if (options & EVENT_CLEAR_ON_EXIT)
+        {
+            g->bits &= ~bits;
+        }
+        EndCriticalSection(savedmask);
+        return groupBits;
+    }
+
+    CurrentlyRunningThread->eventBits = bits;
+    CurrentlyRunningThread->eventOptions = options;
+    CurrentlyRunningThread->blocked = &g->wait;
+    G8RTOS_RemoveFromReadyList(CurrentlyRunningThread);
+    G8RTOS_AddToWaitList(&g->wait.waiters, CurrentlyRunningThread);
+
+    EndCriticalSection(savedmask);
+
+    G8RTOS_Yield();                                 // runs again once G8RTOS_SetEventBits has woken it
+
+    return CurrentlyRunningThread->eventBits;
+}
+
+/*********************************************** Public Functions *********************************************************************/
@@ -0,0 +1,82 @@
+/*
+ * G8RTOS_EventGroup.h
+ */
+
+#ifndef G8RTOS_EVENTGROUP_H_
+#define G8RTOS_EVENTGROUP_H_
+
+#include <stdint.h>
+#include "G8RTOS_WaitObject.h"
+
+/*********************************************** Defines Used *************************************************************************/
+
+/* Options of G8RTOS_WaitEventBits, can be or'ed together */
+#define EVENT_WAIT_ANY          0x00    // wake up when any of the bits is set
+#define EVENT_WAIT_ALL          0x01    // wake up when all of the bits are set
+#define EVENT_CLEAR_ON_EXIT     0x02    // clear the bits waited for when the wait ends
+
+/*********************************************** Defines Used *************************************************************************/
+
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Event Group typedef
+ *      - wait: threads waiting for bits, highest priority first and first come first served within a priority
+ *      - bits: 32 event flags, set by threads or ISRs, waited for by threads
+ */
+typedef struct eventGroup_t
+{
+    waitObject_t wait;
+    volatile uint32_t bits;
+} eventGroup_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes an event group with every bit clear
+ * Param "g": Pointer to event group
+ */
+void G8RTOS_InitEventGroup(eventGroup_t *g);
+
+/*
+ * Sets bits of an event group, can be called from ISRs
+ *  - Wakes every waiting thread whose wait is now satisfied, in priority order
+ *  - Bits of woken EVENT_CLEAR_ON_EXIT waits are cleared once all waiters have been looked at, so every waiter sees the same bits
+ * Param "g": Pointer to event group
+ * Param "bits": Bits to set
+ * Returns: Bits of the group after setting (and clearing for woken waiters)
+ */
+uint32_t G8RTOS_SetEventBits(eventGroup_t *g, uint32_t bits);
+
+/*
+ * Clears bits of an event group, can be called from ISRs
+ * Param "g": Pointer to event group
+ * Param "bits": Bits to clear
+ * Returns: Bits of the group before clearing
+ */
+uint32_t G8RTOS_ClearEventBits(eventGroup_t *g, uint32_t bits);
+
+/*
+ * Returns the bits of an event group
+ */
+uint32_t G8RTOS_GetEventBits(eventGroup_t *g);
+
+/*
+ * Waits until any (EVENT_WAIT_ANY) or all (EVENT_WAIT_ALL) of the given bits of an event group are set
+ *  - Returns right away if they already are, otherwise blocks the thread until G8RTOS_SetEventBits sets them
+ *  - With EVENT_CLEAR_ON_EXIT, the bits waited for are cleared when the wait ends
+ * Param "g": Pointer to event group
+ * Param "bits": Bits to wait for, must not be 0
+ * Param "options": EVENT_WAIT_ANY or EVENT_WAIT_ALL, or'ed with EVENT_CLEAR_ON_EXIT if wanted
+ * Returns: Bits of the group that ended the wait (before clearing)
+ */
+uint32_t G8RTOS_WaitEventBits(eventGroup_t *g, uint32_t bits, uint8_t options);
+
+/*********************************************** Public Functions *********************************************************************/
+
+
+#endif /* G8RTOS_EVENTGROUP_H_ */
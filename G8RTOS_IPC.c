@@ -7,13 +7,17 @@
 #include <G8RTOS.h>
 #include <G8RTOS_IPC.h>
 #include "G8RTOS_Structures.h"
+#include "G8RTOS_Trace.h"
 
 /***************************************************** Includes ***********************************************************************/
 
 /*************************************************** Defines Used *********************************************************************/
 
-#define MAX_FIFOS 4
-#define MAX_FIFO_SIZE 16
+#if (MAX_FIFO_SIZE & (MAX_FIFO_SIZE - 1)) != 0
+#error "MAX_FIFO_SIZE must be a power of 2"
+#endif
+
+#define FIFO_INDEX_MASK (MAX_FIFO_SIZE - 1)
 
 /*************************************************** Defines Used *********************************************************************/
 
@@ -26,6 +30,174 @@ static struct FIFO_t fifoArray[MAX_FIFOS];
 
 /*********************************************** Data Structures Used *****************************************************************/
 
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Returns what is left of a timeout that started at system time start, WAIT_FOREVER stays WAIT_FOREVER
+ */
+static uint32_t RemainingTimeout(uint32_t timeout, uint32_t start)
+{
+    if (timeout == WAIT_FOREVER)
+    {
+        return WAIT_FOREVER;
+    }
+    uint32_t elapsed = SystemTime - start;
+    return (elapsed >= timeout) ? 0 : timeout - elapsed;
+}
+
+/*
+ * Copies up to count words into an SPSC FIFO
+ *  - Only the writer changes tailIndex, so the free space can only grow while the words are copied
+ *  - The words are written before tailIndex publishes them
+ *  - Wakes the reader if it waits and the FIFO holds at least wakeThreshold words
+ * Returns: Number of words written
+ */
+static uint32_t WriteSPSC(FIFO_t * fifo, const int32_t * data, uint32_t count)
+{
+    uint32_t tail = fifo->tailIndex;
+    uint32_t space = MAX_FIFO_SIZE - (tail - fifo->headIndex);
+    uint32_t written = (count < space) ? count : space;
+
+    for (uint32_t i = 0; i < written; i++)
+    {
+        fifo->buffer[(tail + i) & FIFO_INDEX_MASK] = data[i];
+    }
+    G8RTOS_PORT_MEMORY_BARRIER();                           // words in the buffer before the index that publishes them
+    fifo->tailIndex = tail + written;
+    fifo->lostData += count - written;
+
+    G8RTOS_PORT_MEMORY_BARRIER();                           // publish the index before checking whether the reader waits
+    if (fifo->readerWaiting && fifo->tailIndex - fifo->headIndex >= fifo->wakeThreshold)
+    {
+        fifo->readerWaiting = false;
+        G8RTOS_ReleaseSemaphore(&fifo->dataReady);
+    }
+    return written;
+}
+
+/*
+ * Copies up to count words out of an SPSC FIFO, waiting at most timeout ms until there is at least one
+ *  - readerWaiting is set before the last look at tailIndex, so a writer either sees it or the reader sees the new words
+ *  - A wake up that finds the FIFO empty (left from a wait that ended on its own) just waits again
+ *  - The slots are handed back to the writer through headIndex only after they have been read, then a writer blocked
+ *    on a full FIFO is woken
+ * Returns: Number of words read, 0 if the timeout expired first
+ */
+static uint32_t ReadSPSC(FIFO_t * fifo, int32_t * data, uint32_t count, uint32_t timeout)
+{
+    uint32_t head = fifo->headIndex;
+    uint32_t available;
+    uint32_t start = SystemTime;
+
+    while ((available = fifo->tailIndex - head) == 0)
+    {
+        fifo->readerWaiting = true;
+        G8RTOS_PORT_MEMORY_BARRIER();
+        if (fifo->tailIndex != head)
+        {
+            fifo->readerWaiting = false;
+            continue;
+        }
+        if (G8RTOS_AcquireSemaphoreTimeout(&fifo->dataReady, RemainingTimeout(timeout, start)))
+        {
+            fifo->readerWaiting = false;
+            if (fifo->tailIndex == head)
+            {
+                return 0;
+            }
+        }
+    }
+
+    uint32_t read = (count < available) ? count : available;
+    G8RTOS_PORT_MEMORY_BARRIER();                           // words are read only after seeing the index that published them
+    for (uint32_t i = 0; i < read; i++)
+    {
+        data[i] = fifo->buffer[(head + i) & FIFO_INDEX_MASK];
+    }
+    G8RTOS_PORT_MEMORY_BARRIER();                           // done with the slots before the writer may reuse them
+    fifo->headIndex = head + read;
+
+    G8RTOS_PORT_MEMORY_BARRIER();                           // publish the index before checking whether the writer waits
+    if (fifo->writerWaiting)
+    {
+        fifo->writerWaiting = false;
+        G8RTOS_ReleaseSemaphore(&fifo->spaceReady);
+    }
+    return read;
+}
+
+/*
+ * Waits at most timeout ms until an SPSC FIFO has room for a word, the mirror image of the reader's wait in ReadSPSC
+ * Returns: 0 if there is room, 1 if the timeout expired first
+ */
+static int WaitSPSCSpace(FIFO_t * fifo, uint32_t timeout)
+{
+    uint32_t tail = fifo->tailIndex;
+    uint32_t start = SystemTime;
+
+    while (tail - fifo->headIndex == MAX_FIFO_SIZE)
+    {
+        fifo->writerWaiting = true;
+        G8RTOS_PORT_MEMORY_BARRIER();
+        if (tail - fifo->headIndex != MAX_FIFO_SIZE)
+        {
+            fifo->writerWaiting = false;
+            continue;
+        }
+        if (G8RTOS_AcquireSemaphoreTimeout(&fifo->spaceReady, RemainingTimeout(timeout, start)))
+        {
+            fifo->writerWaiting = false;
+            if (tail - fifo->headIndex == MAX_FIFO_SIZE)
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * Puts a word at the tail of a locked mode FIFO the caller has taken a free slot of
+ *  - The tail moves inside a critical section, so threads and ISRs can write at the same time
+ */
+static void WriteLocked(FIFO_t * fifo, int32_t data)
+{
+    uint32_t savedmask = StartCriticalSection();
+    *fifo->tail = data;
+    fifo->tail++;                                               // increment tail
+    if (fifo->tail == &fifo->buffer[MAX_FIFO_SIZE])             // if tail has gone out of bounds...
+    {
+        fifo->tail = fifo->buffer;                              // reset tail to start of buffer
+    }
+    EndCriticalSection(savedmask);
+    G8RTOS_ReleaseSemaphore(&fifo->currentSize);                // release currentSize semaphore
+}
+
+/*
+ * Returns the number of contiguous bytes the consumer of a byte FIFO can read at readIndex
+ *  - When the producer has wrapped and everything up to wrapIndex has been read, moves readIndex back to the start
+ *  - writeIndex is read before wrapIndex, the producer sets wrapIndex before moving writeIndex back
+ */
+static uint32_t ByteFIFOReadable(byteFIFO_t * fifo)
+{
+    uint32_t write = fifo->writeIndex;
+    G8RTOS_PORT_MEMORY_BARRIER();
+    uint32_t read = fifo->readIndex;
+
+    if (write >= read)
+    {
+        return write - read;
+    }
+    if (read == fifo->wrapIndex)
+    {
+        fifo->readIndex = 0;                                // end of the data before the wrap, continue at the start
+        return write;
+    }
+    return fifo->wrapIndex - read;
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
 /*********************************************** Public Functions *********************************************************************/
 
 int G8RTOS_InitFIFO(uint32_t index)
@@ -37,6 +209,38 @@ int G8RTOS_InitFIFO(uint32_t index)
         fifoArray[index].lostData = 0;
         G8RTOS_InitSemaphore(&fifoArray[index].currentSize, 0); // init to 0 because empty FIFOs should block threads until it has data
         G8RTOS_InitSemaphore(&fifoArray[index].mutex, 1);       // init to 1 because no thread currently is reading from this FIFO
+        G8RTOS_InitSemaphore(&fifoArray[index].freeSpace, MAX_FIFO_SIZE);  // every slot is free
+        fifoArray[index].spsc = false;
+
+        return 1;
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+int G8RTOS_InitFIFOSPSC(uint32_t index, uint32_t wakeThreshold)
+{
+    if (index < MAX_FIFOS)
+    {
+        fifoArray[index].spsc = true;
+        fifoArray[index].headIndex = 0;
+        fifoArray[index].tailIndex = 0;
+        fifoArray[index].readerWaiting = false;
+        fifoArray[index].writerWaiting = false;
+        fifoArray[index].lostData = 0;
+        if (wakeThreshold < 1)
+        {
+            wakeThreshold = 1;
+        }
+        if (wakeThreshold > MAX_FIFO_SIZE)
+        {
+            wakeThreshold = MAX_FIFO_SIZE;                       // a full FIFO must always wake the reader
+        }
+        fifoArray[index].wakeThreshold = wakeThreshold;
+        G8RTOS_InitSemaphore(&fifoArray[index].dataReady, 0);
+        G8RTOS_InitSemaphore(&fifoArray[index].spaceReady, 0);
 
         return 1;
     }
@@ -48,47 +252,227 @@ int G8RTOS_InitFIFO(uint32_t index)
 
 int32_t G8RTOS_ReadFIFO(uint32_t index)
 {
-    G8RTOS_AcquireSemaphore(&fifoArray[index].currentSize);     // ensures there is data to be read (buffer isn't empty)
+    int32_t data = 0;
+    G8RTOS_ReadFIFOTimeout(index, &data, WAIT_FOREVER);
+    return data;
+}
+
+int G8RTOS_ReadFIFOTimeout(uint32_t index, int32_t * data, uint32_t timeout)
+{
+    G8RTOS_TRACE_EVENT(TRACE_FIFO_READ, index);
+    if (index >= MAX_FIFOS)
+    {
+        return 1;
+    }
+
+    if (fifoArray[index].spsc)
+    {
+        return ReadSPSC(&fifoArray[index], data, 1, timeout) ? 0 : 1;
+    }
+
+    if (G8RTOS_AcquireSemaphoreTimeout(&fifoArray[index].currentSize, timeout))    // ensures there is data to be read (buffer isn't empty)
+    {
+        return 1;
+    }
     G8RTOS_AcquireSemaphore(&fifoArray[index].mutex);           // ensures that FIFO was not currently being read by another thread
 
-    int32_t data = *fifoArray[index].head;                          // data is at head ptr of FIFO
+    *data = *fifoArray[index].head;                                 // data is at head ptr of FIFO
     fifoArray[index].head++;                                        // set head to next in FIFO
-    if (fifoArray[index].head == (int32_t*)&fifoArray[index].head)  // if head has gone out of bounds...
+    if (fifoArray[index].head == &fifoArray[index].buffer[MAX_FIFO_SIZE])  // if head has gone out of bounds...
     {
-        fifoArray[index].head = (int32_t*)&fifoArray[index].buffer; // reset head to start of buffer
+        fifoArray[index].head = fifoArray[index].buffer;            // reset head to start of buffer
     }
 
     G8RTOS_ReleaseSemaphore(&fifoArray[index].mutex);           // signal other threads that the FIFO is done being read
+    G8RTOS_ReleaseSemaphore(&fifoArray[index].freeSpace);       // the slot can be written again
 
-    return data;
+    return 0;
 }
 
 int G8RTOS_WriteFIFO(uint32_t index, uint32_t data)
 {
-    //G8RTOS_AcquireSemaphore(&fifoArray[index].mutex);
+    G8RTOS_TRACE_EVENT(TRACE_FIFO_WRITE, index);
+    if (index >= MAX_FIFOS)
+    {
+        return 1;
+    }
+
+    if (fifoArray[index].spsc)
+    {
+        int32_t word = (int32_t)data;
+        return WriteSPSC(&fifoArray[index], &word, 1) ? 0 : 1;
+    }
 
-    if (fifoArray[index].currentSize > MAX_FIFO_SIZE - 1)       // check if current size is at full capacity
+    if (G8RTOS_TryAcquireSemaphore(&fifoArray[index].freeSpace))   // check if current size is at full capacity
     {
-        fifoArray[index].currentSize = MAX_FIFO_SIZE - 1;       // discard new data, increment lostData, return error
-        fifoArray[index].lostData++;
+        fifoArray[index].lostData++;                                // discard new data, increment lostData, return error
         return 1;
     }
-    else
+    WriteLocked(&fifoArray[index], (int32_t)data);
+    return 0;
+}
+
+int G8RTOS_WriteFIFOTimeout(uint32_t index, uint32_t data, uint32_t timeout)
+{
+    G8RTOS_TRACE_EVENT(TRACE_FIFO_WRITE, index);
+    if (index >= MAX_FIFOS)
+    {
+        return 1;
+    }
+
+    int32_t word = (int32_t)data;
+    if (fifoArray[index].spsc)
     {
-        *fifoArray[index].tail = data;
-        G8RTOS_ReleaseSemaphore(&fifoArray[index].currentSize);     // release currentSize semaphore
-        fifoArray[index].tail++;                                        // increment tail
-        if(fifoArray[index].tail == (int32_t*)&fifoArray[index].head)   // if tail has gone out of bounds...
+        if (WaitSPSCSpace(&fifoArray[index], timeout))
         {
-            fifoArray[index].tail = fifoArray[index].buffer;            // reset tail to start of buffer
+            return 1;
         }
+        WriteSPSC(&fifoArray[index], &word, 1);
+        return 0;
+    }
 
+    if (G8RTOS_AcquireSemaphoreTimeout(&fifoArray[index].freeSpace, timeout))   // back-pressure: wait for a reader to free a slot
+    {
+        return 1;
+    }
+    WriteLocked(&fifoArray[index], word);
+    return 0;
+}
 
+uint32_t G8RTOS_WriteFIFOBatch(uint32_t index, const int32_t * data, uint32_t count)
+{
+    if (index >= MAX_FIFOS || !fifoArray[index].spsc)
+    {
+        return 0;
     }
+    return WriteSPSC(&fifoArray[index], data, count);
+}
 
-    //G8RTOS_ReleaseSemaphore(&fifoArray[index].mutex);
+uint32_t G8RTOS_ReadFIFOBatch(uint32_t index, int32_t * data, uint32_t count)
+{
+    if (index >= MAX_FIFOS || !fifoArray[index].spsc || count == 0)
+    {
+        return 0;
+    }
+    return ReadSPSC(&fifoArray[index], data, count, WAIT_FOREVER);
+}
 
-    return 0;
+
+void G8RTOS_InitByteFIFO(byteFIFO_t * fifo, uint8_t * storage, uint32_t size)
+{
+    fifo->buffer = storage;
+    fifo->size = size;
+    fifo->readIndex = 0;
+    fifo->writeIndex = 0;
+    fifo->wrapIndex = 0;
+    fifo->reserveIndex = 0;
+    fifo->reserveLength = 0;
+    fifo->readerWaiting = false;
+    G8RTOS_InitSemaphore(&fifo->dataReady, 0);
+}
+
+uint8_t * G8RTOS_ReserveByteFIFO(byteFIFO_t * fifo, uint32_t length)
+{
+    uint32_t write = fifo->writeIndex;
+    uint32_t read = fifo->readIndex;
+    uint32_t start;
+
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    if (write >= read)                          // free space is [write, size) and [0, read)
+    {
+        if (fifo->size - write >= length)
+        {
+            start = write;
+        }
+        else if (read > length)                 // wrap, but never catch up with read (that would look empty)
+        {
+            start = 0;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+    else                                        // already wrapped, free space is [write, read)
+    {
+        if (read - write > length)
+        {
+            start = write;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    fifo->reserveIndex = start;
+    fifo->reserveLength = length;
+    return &fifo->buffer[start];
+}
+
+void G8RTOS_CommitByteFIFO(byteFIFO_t * fifo, uint32_t length)
+{
+    if (length > fifo->reserveLength)
+    {
+        length = fifo->reserveLength;
+    }
+    fifo->reserveLength = 0;
+    if (length == 0)
+    {
+        return;
+    }
+
+    G8RTOS_PORT_MEMORY_BARRIER();                           // block written before the index that publishes it
+    if (fifo->reserveIndex != fifo->writeIndex)
+    {
+        fifo->wrapIndex = fifo->writeIndex;                 // reservation wrapped to the start, data before it ends here
+        G8RTOS_PORT_MEMORY_BARRIER();
+    }
+    fifo->writeIndex = fifo->reserveIndex + length;
+
+    G8RTOS_PORT_MEMORY_BARRIER();                           // publish the index before checking whether the reader waits
+    if (fifo->readerWaiting)
+    {
+        fifo->readerWaiting = false;
+        G8RTOS_ReleaseSemaphore(&fifo->dataReady);
+    }
+}
+
+uint8_t * G8RTOS_PeekByteFIFO(byteFIFO_t * fifo, uint32_t * length)
+{
+    uint32_t readable;
+
+    while ((readable = ByteFIFOReadable(fifo)) == 0)
+    {
+        fifo->readerWaiting = true;
+        G8RTOS_PORT_MEMORY_BARRIER();
+        if (ByteFIFOReadable(fifo))
+        {
+            fifo->readerWaiting = false;
+            continue;
+        }
+        G8RTOS_AcquireSemaphore(&fifo->dataReady);
+    }
+
+    *length = readable;
+    return &fifo->buffer[fifo->readIndex];
+}
+
+void G8RTOS_ReleaseByteFIFO(byteFIFO_t * fifo, uint32_t length)
+{
+    uint32_t read = fifo->readIndex + length;
+    uint32_t write = fifo->writeIndex;
+    G8RTOS_PORT_MEMORY_BARRIER();                           // also: done with the bytes before the producer may reuse them
+
+    if (write < read && read == fifo->wrapIndex)
+    {
+        read = 0;                                           // everything before the wrap is read, give the end back as one block
+    }
+    fifo->readIndex = read;
 }
 
 
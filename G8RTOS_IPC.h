@@ -7,6 +7,7 @@
 
 /***************************************************** Includes ***********************************************************************/
 
+#include <stdbool.h>
 #include <G8RTOS.h>
 
 /***************************************************** Includes ***********************************************************************/
@@ -14,12 +15,22 @@
 /*************************************************** Defines Used *********************************************************************/
 
 #define MAX_FIFOS 4
-#define MAX_FIFO_SIZE 16
+#define MAX_FIFO_SIZE 16            // must be a power of 2 (SPSC indices are masked)
 
 /*************************************************** Defines Used *********************************************************************/
 
 /************************************************* Structures Used ********************************************************************/
 
+/*
+ * FIFO typedef
+ *      - Locked mode (G8RTOS_InitFIFO): any number of readers, head/tail pointers, words counted by the currentSize semaphore
+ *        and free slots by the freeSpace semaphore
+ *      - SPSC mode (G8RTOS_InitFIFOSPSC): one writer (thread or ISR) and one reader thread
+ *          - headIndex/tailIndex count the words ever read/written, the slot is the index masked by MAX_FIFO_SIZE - 1
+ *          - Each index is only written by its own side, so neither side needs a critical section to move data
+ *          - The reader blocks on dataReady, the writer only signals it when the reader waits and wakeThreshold words are in
+ *          - A writer blocked on a full FIFO (G8RTOS_WriteFIFOTimeout) waits on spaceReady the same way
+ */
 typedef struct FIFO_t
 {
     int32_t buffer[MAX_FIFO_SIZE];
@@ -28,8 +39,40 @@ typedef struct FIFO_t
     uint32_t lostData;
     semaphore_t currentSize;
     semaphore_t mutex;
+    semaphore_t freeSpace;
+
+    bool spsc;
+    volatile uint32_t headIndex;
+    volatile uint32_t tailIndex;
+    volatile bool readerWaiting;
+    volatile bool writerWaiting;
+    uint32_t wakeThreshold;
+    semaphore_t dataReady;
+    semaphore_t spaceReady;
 } FIFO_t;
 
+/*
+ * Byte FIFO typedef
+ *      - Ring of bytes in storage given by the application, any size per FIFO
+ *      - One producer (thread or ISR) and one consumer thread, no critical section to move data
+ *      - Producer reserves a contiguous block, fills it in place and commits it; consumer peeks at a contiguous block,
+ *        parses it in place and releases it
+ *      - A block never wraps: if it does not fit at the end of the storage it starts at the beginning and the end of
+ *        the data before it is kept in wrapIndex (data is [readIndex, wrapIndex) then [0, writeIndex) while writeIndex < readIndex)
+ */
+typedef struct byteFIFO_t
+{
+    uint8_t * buffer;
+    uint32_t size;
+    volatile uint32_t readIndex;        // only changed by the consumer
+    volatile uint32_t writeIndex;       // only changed by the producer
+    volatile uint32_t wrapIndex;        // only changed by the producer
+    uint32_t reserveIndex;              // start of the producer's current reservation
+    uint32_t reserveLength;             // length of the producer's current reservation, 0 if none
+    volatile bool readerWaiting;
+    semaphore_t dataReady;
+} byteFIFO_t;
+
 /*********************************************** Structures Used **********************************************************************/
 
 /*********************************************** Public Functions *********************************************************************/
@@ -39,26 +82,100 @@ typedef struct FIFO_t
  */
 int G8RTOS_InitFIFO(uint32_t index);
 
+/*
+ * Initialize the FIFO structure in single producer/single consumer mode
+ *      - Exactly one thread or ISR may write it and exactly one thread may read it
+ *      - Writes never enter a critical section, the reader is only woken once wakeThreshold words are in
+ *      - wakeThreshold is limited to 1..MAX_FIFO_SIZE; above 1 the reader sleeps until that many words were written
+ *      - returns 1 on success, 0 if index is not a FIFO
+ */
+int G8RTOS_InitFIFOSPSC(uint32_t index, uint32_t wakeThreshold);
+
 /*
  * Reads a value from the specified FIFO
  *      - index is the intended FIFO to read from
  *      - returns the data read from the the head
+ *      - in SPSC mode, reads without taking any semaphore unless the FIFO is empty
  *
  * NOTE: any thread reading a FIFO must ensure that the FIFOis being written by another
- *       active thread or else the thread will not run and cannot be killed
+ *       active thread or else the thread will not run and cannot be killed, use G8RTOS_ReadFIFOTimeout if that can happen
  */
 int32_t G8RTOS_ReadFIFO(uint32_t index);
 
+/*
+ * Reads a value from the specified FIFO, waiting at most timeout ms for one
+ *      - data receives the value read
+ *      - timeout 0 only reads if a value is there, WAIT_FOREVER waits like G8RTOS_ReadFIFO
+ *      - returns 0 if a value was read, 1 if the timeout expired first (or index is not a FIFO)
+ */
+int G8RTOS_ReadFIFOTimeout(uint32_t index, int32_t * data, uint32_t timeout);
+
 /*
  * Writes a value to the specified FIFO
  *      - index is the intended FIFO to write to
  *      - data is the value to write to the tail
  *      - returns
  *      - if FIFO is full (buffer > 16) then discard the new data and increment dataLost
- *      - returns error if full buffer
+ *      - returns error if full buffer (or index is not a FIFO)
+ *      - in SPSC mode, never enters a critical section unless the reader has to be woken
  */
 int G8RTOS_WriteFIFO(uint32_t index, uint32_t data);
 
+/*
+ * Writes a value to the specified FIFO, waiting at most timeout ms for room (back-pressure instead of lostData)
+ *      - only for threads, ISRs use G8RTOS_WriteFIFO
+ *      - in SPSC mode the single writer must be a thread to use this
+ *      - returns 0 if the value was written, 1 if the FIFO stayed full until the timeout expired (or index is not a FIFO)
+ */
+int G8RTOS_WriteFIFOTimeout(uint32_t index, uint32_t data, uint32_t timeout);
+
+/*
+ * Writes up to count words to an SPSC FIFO with one index update and at most one reader wake up
+ *      - words that do not fit are discarded and added to lostData
+ *      - returns the number of words written, 0 if the FIFO is not in SPSC mode
+ */
+uint32_t G8RTOS_WriteFIFOBatch(uint32_t index, const int32_t * data, uint32_t count);
+
+/*
+ * Reads up to count words from an SPSC FIFO with one index update
+ *      - blocks until at least one word is available, then reads every available word up to count
+ *      - returns the number of words read, 0 if the FIFO is not in SPSC mode
+ */
+uint32_t G8RTOS_ReadFIFOBatch(uint32_t index, int32_t * data, uint32_t count);
+
+/*
+ * Initializes a byte FIFO on storage given by the application
+ *      - storage must stay valid as long as the FIFO is used
+ *      - a block can only be reserved where that many contiguous bytes are free, at most size bytes
+ */
+void G8RTOS_InitByteFIFO(byteFIFO_t * fifo, uint8_t * storage, uint32_t size);
+
+/*
+ * Reserves a contiguous block of length bytes for the producer to write into
+ *      - returns a pointer into the FIFO's storage, 0 if there is not enough contiguous space (never blocks)
+ *      - a new reservation replaces one that has not been committed
+ */
+uint8_t * G8RTOS_ReserveByteFIFO(byteFIFO_t * fifo, uint32_t length);
+
+/*
+ * Hands the first length bytes of the current reservation to the consumer
+ *      - length may be smaller than what was reserved, 0 drops the reservation
+ *      - wakes the consumer if it waits in G8RTOS_PeekByteFIFO
+ */
+void G8RTOS_CommitByteFIFO(byteFIFO_t * fifo, uint32_t length);
+
+/*
+ * Returns a pointer to the oldest committed bytes without removing them
+ *      - blocks until there is data, then *length is the number of contiguous bytes at the pointer
+ *      - blocks are never split, so a block committed in one piece is returned in one piece (possibly with the blocks after it)
+ */
+uint8_t * G8RTOS_PeekByteFIFO(byteFIFO_t * fifo, uint32_t * length);
+
+/*
+ * Frees the first length bytes returned by G8RTOS_PeekByteFIFO for the producer to reuse
+ */
+void G8RTOS_ReleaseByteFIFO(byteFIFO_t * fifo, uint32_t length);
+
 /*********************************************** Public Functions *********************************************************************/
 
 #endif /* G8RTOS_G8RTOS_IPC_H_ */
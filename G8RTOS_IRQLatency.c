@@ -0,0 +1,247 @@
+/*
+ * G8RTOS_IRQLatency.c
+ */
+
+/***************************************************** Includes ***********************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "G8RTOS_IRQLatency.h"
+#include "G8RTOS_Port.h"
+#include "G8RTOS_Scheduler.h"
+#include "G8RTOS_Structures.h"
+
+/***************************************************** Includes ***********************************************************************/
+
+#if G8RTOS_IRQ_LATENCY
+
+/*************************************************** Defines Used *********************************************************************/
+
+#define IRQ_LATENCY_IRQS (PORT6_IRQn + 1)      // interrupts G8RTOS_AddAPeriodicEvent accepts
+
+/*************************************************** Defines Used *********************************************************************/
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*
+ * Measured interrupt
+ *      - entry: cycle count at the trampoline's entry of the last interrupt
+ *      - woken: thread the last interrupt woke, until it runs
+ *      - released: the running handler has woken a thread
+ *      - releases / releaseTotal / latencyTotal: counts and sums behind the means
+ */
+typedef struct irqSource_t
+{
+    IRQn_Type irq;
+    void (*handler)(void);
+    uint32_t entry;
+    tcb_t * woken;
+    bool released;
+    uint32_t releases;
+    uint64_t releaseTotal;
+    uint64_t latencyTotal;
+    irqLatencyStats_t stats;
+} irqSource_t;
+
+static irqSource_t irqSources[IRQ_LATENCY_SOURCES];
+static uint32_t irqSourceCount;
+
+/*
+ * Index + 1 of each interrupt's entry in irqSources, 0 if it is not measured
+ */
+static uint8_t sourceOf[IRQ_LATENCY_IRQS];
+
+/*
+ * Source whose handler is running (the innermost one if they nest), 0 in thread context
+ */
+static irqSource_t * activeSource;
+
+/*
+ * Sources with a woken thread that has not run yet, so the scheduler hook returns right away most of the time
+ */
+static uint32_t pendingSwitches;
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Returns the histogram bucket of a cycle count, log2 of it rounded down plus one, 0 for 0
+ */
+static uint32_t LatencyBucket(uint32_t cycles)
+{
+    uint32_t bucket = cycles ? 32 - G8RTOS_PORT_CLZ(cycles) : 0;
+    return bucket < IRQ_LATENCY_BUCKETS ? bucket : IRQ_LATENCY_BUCKETS - 1;
+}
+
+/*
+ * Clears the statistics of a source
+ */
+static void ResetSource(irqSource_t * source)
+{
+    source->releases = 0;
+    source->releaseTotal = 0;
+    source->latencyTotal = 0;
+    memset(&source->stats, 0, sizeof(irqLatencyStats_t));
+    source->stats.minRelease = UINT32_MAX;
+    source->stats.minLatency = UINT32_MAX;
+}
+
+/*
+ * Installed in the vector table instead of the handlers of measured aperiodic events
+ *  - Stamps the entry first, then runs the event's handler with the source marked as active
+ */
+static void IRQLatencyTrampoline(void)
+{
+    uint32_t entry = G8RTOS_PortGetCycles();
+    irqSource_t * source = &irqSources[sourceOf[G8RTOS_PortActiveInterrupt()] - 1];
+
+    uint32_t savedmask = StartCriticalSection();
+    source->entry = entry;
+    source->released = false;
+    irqSource_t * interrupted = activeSource;
+    activeSource = source;
+    EndCriticalSection(savedmask);
+
+    source->handler();
+
+    savedmask = StartCriticalSection();
+    activeSource = interrupted;
+    if (!source->released)
+    {
+        source->stats.noWake++;
+    }
+    EndCriticalSection(savedmask);
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+int G8RTOS_GetIRQLatency(IRQn_Type IRQn, irqLatencyStats_t * stats, bool reset)
+{
+    if (IRQn < PSS_IRQn || IRQn >= IRQ_LATENCY_IRQS || !sourceOf[IRQn])
+    {
+        return 1;
+    }
+
+    uint32_t savedmask = StartCriticalSection();
+    irqSource_t * source = &irqSources[sourceOf[IRQn] - 1];
+    if (stats)
+    {
+        *stats = source->stats;
+        stats->meanRelease = source->releases ? (uint32_t)(source->releaseTotal / source->releases) : 0;
+        stats->meanLatency = source->stats.samples ? (uint32_t)(source->latencyTotal / source->stats.samples) : 0;
+        if (!source->releases)
+        {
+            stats->minRelease = 0;
+        }
+        if (!source->stats.samples)
+        {
+            stats->minLatency = 0;
+        }
+    }
+    if (reset)
+    {
+        ResetSource(source);
+    }
+    EndCriticalSection(savedmask);
+    return 0;
+}
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+void (*G8RTOS_IRQLatencyHandler(IRQn_Type IRQn, void (*handler)(void)))(void)
+{
+    if (!sourceOf[IRQn])
+    {
+        if (irqSourceCount == IRQ_LATENCY_SOURCES)
+        {
+            return handler;         // not measured, runs directly
+        }
+        irqSources[irqSourceCount].irq = IRQn;
+        sourceOf[IRQn] = ++irqSourceCount;
+    }
+
+    irqSource_t * source = &irqSources[sourceOf[IRQn] - 1];
+    if (source->woken)
+    {
+        pendingSwitches--;
+    }
+    source->handler = handler;
+    source->woken = 0;
+    ResetSource(source);
+    return IRQLatencyTrampoline;
+}
+
+void G8RTOS_IRQLatencyWake(tcb_t * thread)
+{
+    irqSource_t * source = activeSource;
+    if (!source || source->released || G8RTOS_PortActiveInterrupt() != source->irq)
+    {
+        return;                     // not in a measured handler (a SysTick nesting in one does not count), or not its first wake
+    }
+
+    uint32_t release = G8RTOS_PortGetCycles() - source->entry;
+    source->released = true;
+    if (!source->woken)
+    {
+        pendingSwitches++;
+    }
+    source->woken = thread;         // a thread woken by the previous interrupt that has not run yet is not counted
+
+    source->releases++;
+    source->releaseTotal += release;
+    source->stats.minRelease = release < source->stats.minRelease ? release : source->stats.minRelease;
+    source->stats.maxRelease = release > source->stats.maxRelease ? release : source->stats.maxRelease;
+}
+
+void G8RTOS_IRQLatencySwitch(tcb_t * thread)
+{
+    if (!pendingSwitches)
+    {
+        return;
+    }
+
+    uint32_t now = G8RTOS_PortGetCycles();
+    for (uint32_t i = 0; i < irqSourceCount; i++)
+    {
+        irqSource_t * source = &irqSources[i];
+        if (source->woken == thread)
+        {
+            uint32_t latency = now - source->entry;
+            source->woken = 0;
+            pendingSwitches--;
+
+            source->stats.samples++;
+            source->latencyTotal += latency;
+            source->stats.minLatency = latency < source->stats.minLatency ? latency : source->stats.minLatency;
+            source->stats.maxLatency = latency > source->stats.maxLatency ? latency : source->stats.maxLatency;
+            source->stats.histogram[LatencyBucket(latency)]++;
+        }
+    }
+}
+
+void G8RTOS_IRQLatencyForget(tcb_t * thread)
+{
+    if (!pendingSwitches)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < irqSourceCount; i++)
+    {
+        if (irqSources[i].woken == thread)
+        {
+            irqSources[i].woken = 0;        // the interrupt is not counted, like one whose thread was woken again
+            pendingSwitches--;
+        }
+    }
+}
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+#endif /* G8RTOS_IRQ_LATENCY */
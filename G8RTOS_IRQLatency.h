@@ -0,0 +1,123 @@
+/*
+ * G8RTOS_IRQLatency.h
+ *
+ * Interrupt-to-thread latency of the events added with G8RTOS_AddAPeriodicEvent
+ *      - Enable with G8RTOS_IRQ_LATENCY 1, with 0 the hooks compile to nothing and there are no tables
+ *      - The event's handler is called through a trampoline that stamps the IRQ entry
+ *      - The first thread the handler wakes (semaphore, FIFO, notification or event group) stamps the release
+ *      - The woken thread being switched to stamps the end, as the last step of the context switch before its context is loaded
+ *      - All times are G8RTOS_PortGetCycles counts (DWT CYCCNT on MSP432, nanoseconds on the POSIX host)
+ */
+
+#ifndef G8RTOS_IRQLATENCY_H_
+#define G8RTOS_IRQLATENCY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "G8RTOS_Port.h"
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+#ifndef G8RTOS_IRQ_LATENCY
+#define G8RTOS_IRQ_LATENCY 0        // 1: aperiodic events measure the latency from the IRQ to the thread they wake
+#endif
+#ifndef IRQ_LATENCY_SOURCES
+#define IRQ_LATENCY_SOURCES 8       // aperiodic events that are measured, the ones added after that run without trampoline
+#endif
+#define IRQ_LATENCY_BUCKETS 16      // log2 buckets of the latency histogram, the last one takes everything above
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Latency statistics of one interrupt, see G8RTOS_GetIRQLatency
+ *      - samples: interrupts whose woken thread has run
+ *      - noWake: interrupts whose handler returned without waking a thread
+ *      - min/max/meanRelease: cycles from IRQ entry to the first thread being woken
+ *      - min/max/meanLatency: cycles from IRQ entry to the woken thread running
+ *      - histogram: latencies, bucket 0 counts 0 cycles, bucket k counts [2^(k-1), 2^k) cycles
+ *      - If the interrupt fires again before the thread it woke ran, the earlier interrupt is not counted
+ */
+typedef struct irqLatencyStats_t
+{
+    uint32_t samples;
+    uint32_t noWake;
+    uint32_t minRelease;
+    uint32_t maxRelease;
+    uint32_t meanRelease;
+    uint32_t minLatency;
+    uint32_t maxLatency;
+    uint32_t meanLatency;
+    uint32_t histogram[IRQ_LATENCY_BUCKETS];
+} irqLatencyStats_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+#if G8RTOS_IRQ_LATENCY
+
+/*
+ * Copies the latency statistics of an interrupt
+ * Param "IRQn": Interrupt added with G8RTOS_AddAPeriodicEvent
+ * Param "stats": Receives the statistics, may be 0 to only reset them
+ * Param "reset": true to clear the statistics after copying them
+ * Returns: 0 on success, 1 if the interrupt is not measured
+ */
+int G8RTOS_GetIRQLatency(IRQn_Type IRQn, irqLatencyStats_t * stats, bool reset);
+
+#endif /* G8RTOS_IRQ_LATENCY */
+
+/*********************************************** Public Functions *********************************************************************/
+
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+#if G8RTOS_IRQ_LATENCY
+
+struct tcb_t;
+
+/*
+ * Returns the handler to install for an aperiodic event: the trampoline, or handler itself once every source is taken
+ *  - Must be called inside a critical section
+ */
+void (*G8RTOS_IRQLatencyHandler(IRQn_Type IRQn, void (*handler)(void)))(void);
+
+/*
+ * Stamps the release if a measured interrupt handler is running and has not woken a thread yet
+ *  - Called wherever a waiting thread is made ready again
+ */
+void G8RTOS_IRQLatencyWake(struct tcb_t * thread);
+
+/*
+ * Stamps the end of the measurement of every interrupt that woke thread, which is about to run
+ *  - Called by G8RTOS_Scheduler with the thread it chose
+ */
+void G8RTOS_IRQLatencySwitch(struct tcb_t * thread);
+
+/*
+ * Drops the measurements still waiting for thread to run, it was killed and its thread control block is being freed
+ *  - Called by the scheduler when it frees a thread, so a new thread in the same block is not measured as the woken one
+ */
+void G8RTOS_IRQLatencyForget(struct tcb_t * thread);
+
+#define G8RTOS_IRQ_LATENCY_HANDLER(IRQn, handler) G8RTOS_IRQLatencyHandler((IRQn), (handler))
+#define G8RTOS_IRQ_LATENCY_WAKE(thread) G8RTOS_IRQLatencyWake(thread)
+#define G8RTOS_IRQ_LATENCY_SWITCH(thread) G8RTOS_IRQLatencySwitch(thread)
+#define G8RTOS_IRQ_LATENCY_FORGET(thread) G8RTOS_IRQLatencyForget(thread)
+
+#else
+
+#define G8RTOS_IRQ_LATENCY_HANDLER(IRQn, handler) (handler)
+#define G8RTOS_IRQ_LATENCY_WAKE(thread) ((void)0)
+#define G8RTOS_IRQ_LATENCY_SWITCH(thread) ((void)0)
+#define G8RTOS_IRQ_LATENCY_FORGET(thread) ((void)0)
+
+#endif /* G8RTOS_IRQ_LATENCY */
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+#endif /* G8RTOS_IRQLATENCY_H_ */
@@ -0,0 +1,235 @@
+/*
+ * G8RTOS_Mutex.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include <stdint.h>
+#include "G8RTOS_Mutex.h"
+#include "G8RTOS_Port.h"
+#include "G8RTOS_Scheduler.h"
+#include "G8RTOS_Structures.h"
+
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Recomputes the priority of a thread from the mutexes it owns
+ *  - A thread runs at its base priority or at the priority of the highest priority waiter of any mutex it owns, whichever is higher
+ *  - If the thread waits for a mutex itself, its new priority is passed on to the owner (G8RTOS_ChangePriority has already
+ *    moved it to its new place in the mutex's wait list), up the whole chain of owners until a priority stays the same
+ *  - Must be called inside a critical section
+ */
+static void UpdatePriority(tcb_t * thread)
+{
+    while (thread)
+    {
+        uint8_t priority = thread->basePriority;
+        for (mutex_t * m = thread->heldMutexes; m; m = m->nextHeld)
+        {
+            if (m->wait.waiters && m->wait.waiters->priority < priority)
+            {
+                priority = m->wait.waiters->priority;            // waiters are sorted, the head has the highest priority
+            }
+        }
+
+        if (priority == thread->priority)
+        {
+            return;
+        }
+        G8RTOS_ChangePriority(thread, priority);
+
+        if (!thread->blocked || thread->blocked->type != WAIT_MUTEX)
+        {
+            return;
+        }
+        thread = ((mutex_t *)thread->blocked)->owner;
+    }
+}
+
+/*
+ * Removes a mutex from the list of mutexes its owner holds
+ */
+static void RemoveHeldMutex(tcb_t * thread, mutex_t * m)
+{
+    mutex_t ** held = &thread->heldMutexes;
+    while (*held && *held != m)
+    {
+        held = &(*held)->nextHeld;
+    }
+    if (*held)
+    {
+        *held = m->nextHeld;
+    }
+    m->nextHeld = 0;
+}
+
+/*
+ * Gives an unlocked mutex to the head of its wait list and makes that thread ready
+ *  - The new owner inherits from the waiters left behind it
+ *  - Must be called inside a critical section
+ * Returns: The new owner, 0 if nobody waited and the mutex stays unlocked
+ */
+static tcb_t * HandOver(mutex_t * m)
+{
+    tcb_t * next = m->wait.waiters;
+    if (!next)
+    {
+        m->owner = 0;
+        m->lockCount = 0;
+        return 0;
+    }
+
+    m->wait.waiters = next->waitNext;
+    next->waitNext = 0;
+    next->blocked = 0;
+
+    m->owner = next;
+    m->lockCount = 1;
+    m->nextHeld = next->heldMutexes;
+    next->heldMutexes = m;
+
+    UpdatePriority(next);
+    G8RTOS_AddToReadyList(next);
+    return next;
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes a mutex to unlocked
+ * Param "m": Pointer to mutex
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_InitMutex(mutex_t *m)
+{
+    uint32_t savedmask = StartCriticalSection();
+    m->owner = 0;
+    m->lockCount = 0;
+    m->wait.waiters = 0;
+    m->wait.type = WAIT_MUTEX;
+    m->nextHeld = 0;
+    EndCriticalSection(savedmask);
+}
+
+/*
+ * Locks a mutex
+ *  - Takes it right away if it is unlocked, or counts one more lock if the calling thread already owns it
+ *  - Otherwise blocks the thread in the mutex's wait list and raises the owner (and whatever it waits on) to the thread's priority
+ *  - When the thread runs again, the unlocking thread has already made it the owner
+ * Param "m": Pointer to mutex to lock
+ * THIS IS A CRITICAL SECTION
+ */
+void G8RTOS_LockMutex(mutex_t *m)
+{
+    uint32_t savedmask = StartCriticalSection();
+
+    if (m->owner == 0)
+    {
+        m->owner = CurrentlyRunningThread;
+        m->lockCount = 1;
+        m->nextHeld = CurrentlyRunningThread->heldMutexes;
+        CurrentlyRunningThread->heldMutexes = m;
+    }
+    else if (m->owner == CurrentlyRunningThread)
+    {
+        m->lockCount++;                             // recursive lock
+    }
+    else
+    {
+        CurrentlyRunningThread->blocked = &m->wait;
+        G8RTOS_RemoveFromReadyList(CurrentlyRunningThread);
+        G8RTOS_AddToWaitList(&m->wait.waiters, CurrentlyRunningThread);
+        UpdatePriority(m->owner);                   // priority inheritance
+
+        EndCriticalSection(savedmask);
+
+        G8RTOS_Yield();
+        return;
+    }
+
+    EndCriticalSection(savedmask);
+}
+
+/*
+ * Unlocks a mutex
+ *  - Once unlocked as often as it was locked, hands it to the highest priority waiter and lets the scheduler run it
+ *  - Drops the calling thread back to the priority it needs for the mutexes it still owns
+ * Param "m": Pointer to mutex to unlock
+ * Returns: 0 on success, 1 if the calling thread does not own the mutex
+ * THIS IS A CRITICAL SECTION
+ */
+int G8RTOS_UnlockMutex(mutex_t *m)
+{
+    uint32_t savedmask = StartCriticalSection();
+
+    if (m->owner != CurrentlyRunningThread)
+    {
+        EndCriticalSection(savedmask);
+        return 1;       // RETURN ERROR (only the owner can unlock)
+    }
+
+    if (--m->lockCount > 0)
+    {
+        EndCriticalSection(savedmask);
+        return 0;       // still locked by an outer recursive lock
+    }
+
+    RemoveHeldMutex(CurrentlyRunningThread, m);
+    tcb_t * next = HandOver(m);
+    UpdatePriority(CurrentlyRunningThread);         // give back what was inherited through this mutex
+
+    EndCriticalSection(savedmask);
+
+    if (next)
+    {
+        G8RTOS_Yield();
+    }
+    return 0;
+}
+
+/*********************************************** Public Functions *********************************************************************/
+
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Takes a thread that is being killed out of the mutex it waits for and hands over every mutex it owns
+ *  - The owner of the mutex it waited for no longer inherits its priority
+ *  - Mutexes it owned go to their highest priority waiter, or are left unlocked
+ */
+void G8RTOS_AbandonMutexes(tcb_t * thread)
+{
+    if (thread->blocked && thread->blocked->type == WAIT_MUTEX)
+    {
+        mutex_t * waitingFor = (mutex_t *)thread->blocked;
+        G8RTOS_RemoveFromWaitList(&waitingFor->wait.waiters, thread);
+        thread->blocked = 0;
+        UpdatePriority(waitingFor->owner);
+    }
+
+    while (thread->heldMutexes)
+    {
+        mutex_t * m = thread->heldMutexes;
+        thread->heldMutexes = m->nextHeld;
+        m->nextHeld = 0;
+        HandOver(m);
+    }
+    thread->priority = thread->basePriority;
+}
+
+/*
+ * Recomputes a thread's priority after its basePriority was changed, see UpdatePriority
+ */
+void G8RTOS_UpdateMutexPriority(tcb_t * thread)
+{
+    UpdatePriority(thread);
+}
+
+/*********************************************** Kernel Functions *********************************************************************/
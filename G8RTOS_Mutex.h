@@ -0,0 +1,80 @@
+/*
+ * G8RTOS_Mutex.h
+ */
+
+#ifndef G8RTOS_MUTEX_H_
+#define G8RTOS_MUTEX_H_
+
+#include <stdint.h>
+#include "G8RTOS_WaitObject.h"
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Mutex typedef
+ *      - wait: threads waiting to own the mutex, highest priority first and first come first served within a priority
+ *      - owner: thread that locked the mutex, 0 when unlocked
+ *      - lockCount: number of times the owner locked it, it is unlocked once the owner unlocked it as often
+ *      - nextHeld: next mutex owned by the same thread
+ *      - The owner runs at the priority of its highest priority waiter if that is higher than its own (priority inheritance),
+ *        and passes it on to the owner of the mutex it waits for itself (transitive inheritance)
+ */
+typedef struct mutex_t
+{
+    waitObject_t wait;
+    struct tcb_t * owner;
+    uint32_t lockCount;
+    struct mutex_t * nextHeld;
+} mutex_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes a mutex to unlocked
+ * Param "m": Pointer to mutex
+ */
+void G8RTOS_InitMutex(mutex_t *m);
+
+/*
+ * Locks a mutex
+ *  - Takes it right away if it is unlocked, or counts one more lock if the calling thread already owns it
+ *  - Otherwise blocks the thread until the mutex is handed to it, raising the owner's priority to the thread's if needed
+ * Param "m": Pointer to mutex to lock
+ */
+void G8RTOS_LockMutex(mutex_t *m);
+
+/*
+ * Unlocks a mutex
+ *  - Once unlocked as often as it was locked, hands it to the highest priority waiter
+ *  - Drops the calling thread back to the priority it needs for the mutexes it still owns
+ * Param "m": Pointer to mutex to unlock
+ * Returns: 0 on success, 1 if the calling thread does not own the mutex
+ */
+int G8RTOS_UnlockMutex(mutex_t *m);
+
+/*********************************************** Public Functions *********************************************************************/
+
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Takes a thread that is being killed out of the mutex it waits for and hands over every mutex it owns
+ *  - Must be called inside a critical section
+ */
+void G8RTOS_AbandonMutexes(struct tcb_t * thread);
+
+/*
+ * Recomputes a thread's priority after its basePriority was changed
+ *  - A higher priority inherited through a mutex it owns is kept
+ *  - If the thread waits for a mutex, the change is passed on to the owner (and on along the chain)
+ *  - Must be called inside a critical section
+ */
+void G8RTOS_UpdateMutexPriority(struct tcb_t * thread);
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+
+#endif /* G8RTOS_MUTEX_H_ */
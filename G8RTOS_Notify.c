@@ -0,0 +1,122 @@
+/*
+ * G8RTOS_Notify.c
+ */
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "G8RTOS_Notify.h"
+#include "G8RTOS_Port.h"
+#include "G8RTOS_Scheduler.h"
+#include "G8RTOS_Structures.h"
+
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Notifies a thread
+ *  - Only touches the target's thread control block: the waiting thread is the only entry of its own notifyWait
+ *  - A waiting thread is handed the notification here (value in eventBits, notifyClear applied), so it does not have to
+ *    take it itself once it runs
+ *  - A context switch is only triggered if the woken thread has a higher priority than the running one
+ * THIS IS A CRITICAL SECTION
+ */
+int G8RTOS_Notify(uint32_t threadId, uint32_t value, notifyAction_t action)
+{
+    uint32_t savedmask = StartCriticalSection();
+
+    tcb_t * thread = G8RTOS_GetThread(threadId);
+    if (!thread)
+    {
+        EndCriticalSection(savedmask);
+        return 1;       // RETURN ERROR (thread was killed or never existed)
+    }
+
+    switch (action)
+    {
+    case NOTIFY_SET_BITS:
+        thread->notifyValue |= value;
+        break;
+    case NOTIFY_INCREMENT:
+        thread->notifyValue++;
+        break;
+    case NOTIFY_OVERWRITE:
+        thread->notifyValue = value;
+        break;
+    }
+
+    bool preempt = false;
+    if (thread->blocked == &thread->notifyWait)
+    {
+        thread->eventBits = thread->notifyValue;
+        thread->notifyValue &= ~thread->notifyClear;
+        G8RTOS_EndWait(thread);
+        preempt = thread->priority < CurrentlyRunningThread->priority;
+    }
+    else
+    {
+        thread->notifyPending = true;
+    }
+    EndCriticalSection(savedmask);
+
+    if (preempt)
+    {
+        G8RTOS_Yield();
+    }
+    return 0;
+}
+
+/*
+ * Waits until the calling thread is notified
+ *  - Takes a pending notification right away, otherwise blocks on the thread's own notifyWait with the timeout in the
+ *    sleeping list
+ *  - G8RTOS_Notify hands the notification over while the thread is blocked, a timeout leaves timedOut set instead
+ * THIS IS A CRITICAL SECTION
+ */
+int G8RTOS_NotifyWait(uint32_t clearOnExit, uint32_t * value, uint32_t timeout)
+{
+    uint32_t savedmask = StartCriticalSection();
+
+    if (CurrentlyRunningThread->notifyPending)
+    {
+        if (value)
+        {
+            *value = CurrentlyRunningThread->notifyValue;
+        }
+        CurrentlyRunningThread->notifyValue &= ~clearOnExit;
+        CurrentlyRunningThread->notifyPending = false;
+        EndCriticalSection(savedmask);
+        return 0;
+    }
+
+    if (timeout == 0)
+    {
+        EndCriticalSection(savedmask);
+        return 1;
+    }
+
+    CurrentlyRunningThread->notifyClear = clearOnExit;
+    CurrentlyRunningThread->blocked = &CurrentlyRunningThread->notifyWait;
+    G8RTOS_RemoveFromReadyList(CurrentlyRunningThread);
+    G8RTOS_AddToWaitList(&CurrentlyRunningThread->notifyWait.waiters, CurrentlyRunningThread);
+    G8RTOS_StartTimeout(CurrentlyRunningThread, timeout);
+    EndCriticalSection(savedmask);
+
+    G8RTOS_Yield();                                 // runs again once notified or timed out
+
+    if (CurrentlyRunningThread->timedOut)
+    {
+        return 1;
+    }
+    if (value)
+    {
+        *value = CurrentlyRunningThread->eventBits;
+    }
+    return 0;
+}
+
+/*********************************************** Public Functions *********************************************************************/
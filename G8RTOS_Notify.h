@@ -0,0 +1,54 @@
+/*
+ * G8RTOS_Notify.h
+ *
+ * Direct-to-thread notifications: every thread has a 32-bit notification value other threads and ISRs can signal it through,
+ * without a semaphore or any other shared object
+ */
+
+#ifndef G8RTOS_NOTIFY_H_
+#define G8RTOS_NOTIFY_H_
+
+#include <stdint.h>
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * How G8RTOS_Notify changes the notification value
+ */
+typedef enum
+{
+    NOTIFY_SET_BITS     = 0,    // value |= bits, an event flag per bit
+    NOTIFY_INCREMENT    = 1,    // value += 1, a counting semaphore owned by the thread
+    NOTIFY_OVERWRITE    = 2     // notification value = value, a mailbox holding the latest value
+} notifyAction_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Notifies a thread, callable from ISRs
+ *  - Changes the thread's notification value and marks a notification as pending
+ *  - If the thread waits in G8RTOS_NotifyWait it is made ready right away, and runs next if it has a higher priority
+ * Param "threadId": Thread to notify (threadId_t)
+ * Param "value": Bits to set or value to write, unused by NOTIFY_INCREMENT
+ * Param "action": NOTIFY_SET_BITS, NOTIFY_INCREMENT or NOTIFY_OVERWRITE
+ * Returns: 0 on success, 1 if there is no thread with that ID
+ */
+int G8RTOS_Notify(uint32_t threadId, uint32_t value, notifyAction_t action);
+
+/*
+ * Waits until the calling thread is notified
+ *  - Returns right away if a notification is already pending
+ * Param "clearOnExit": Bits of the notification value cleared when a notification is taken (0xFFFFFFFF resets it to 0)
+ * Param "value": If not 0, receives the notification value before clearing
+ * Param "timeout": Milliseconds to wait at most, 0 to only check, WAIT_FOREVER to wait without timeout
+ * Returns: 0 if a notification was taken, 1 if the timeout expired first
+ */
+int G8RTOS_NotifyWait(uint32_t clearOnExit, uint32_t * value, uint32_t timeout);
+
+/*********************************************** Public Functions *********************************************************************/
+
+
+#endif /* G8RTOS_NOTIFY_H_ */
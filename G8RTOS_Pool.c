@@ -0,0 +1,231 @@
+/*
+ * G8RTOS_Pool.c
+ */
+
+/***************************************************** Includes ***********************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "G8RTOS_Pool.h"
+#include "G8RTOS_Port.h"
+#include "G8RTOS_Semaphores.h"
+
+/***************************************************** Includes ***********************************************************************/
+
+/*************************************************** Defines Used *********************************************************************/
+
+#define POOL_MESSAGE_SHIFT 24
+#define POOL_MESSAGE_BLOCK_MASK ((1 << POOL_MESSAGE_SHIFT) - 1)
+
+/*************************************************** Defines Used *********************************************************************/
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*
+ * Declaration of the Array of Pools, a pool is in use while its count is non-zero
+ */
+static pool_t poolArray[MAX_POOLS];
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Takes the first block of the free list
+ *  - The free list must not be empty, must be called inside a critical section
+ */
+static void * PopBlock(pool_t * pool)
+{
+    void * block = pool->freeList;
+    pool->freeList = *(void **)block;
+
+    pool->usedBlocks++;
+    if (pool->usedBlocks > pool->highWater)
+    {
+        pool->highWater = pool->usedBlocks;
+    }
+    return block;
+}
+
+/*
+ * Returns true if block is the start of one of the pool's blocks
+ */
+static bool IsPoolBlock(pool_t * pool, void * block)
+{
+    uint8_t * address = (uint8_t *)block;
+    if (address < pool->storage || address >= pool->storage + pool->blockSize * pool->count)
+    {
+        return false;
+    }
+    return ((uint32_t)(address - pool->storage) % pool->blockSize) == 0;
+}
+
+#if POOL_DOUBLE_FREE_CHECK
+/*
+ * Returns true if block is in the pool's free list, walks the whole list
+ *  - Must be called inside a critical section
+ */
+static bool IsFreeBlock(pool_t * pool, void * block)
+{
+    for (void * free = pool->freeList; free; free = *(void **)free)
+    {
+        if (free == block)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+pool_t * G8RTOS_PoolCreate(uint32_t blockSize, uint32_t count, void * storage)
+{
+    if (blockSize == 0 || count == 0 || count > POOL_MESSAGE_BLOCK_MASK + 1 || storage == 0)
+    {
+        return 0;
+    }
+
+    uint32_t savedmask = StartCriticalSection();
+    pool_t * pool = 0;
+    for (uint32_t i = 0; i < MAX_POOLS; i++)
+    {
+        if (poolArray[i].count == 0)
+        {
+            pool = &poolArray[i];
+            break;
+        }
+    }
+    if (!pool)
+    {
+        EndCriticalSection(savedmask);
+        return 0;       // RETURN ERROR (all pools in use)
+    }
+
+    pool->storage = (uint8_t *)storage;
+    pool->blockSize = G8RTOS_POOL_BLOCK_BYTES(blockSize);
+    pool->count = count;
+    pool->usedBlocks = 0;
+    pool->highWater = 0;
+    pool->failedAllocs = 0;
+    G8RTOS_InitSemaphore(&pool->available, count);
+
+    // link every block into the free list, first block first
+    pool->freeList = 0;
+    for (uint32_t i = count; i > 0; i--)
+    {
+        void ** block = (void **)(pool->storage + (i - 1) * pool->blockSize);
+        *block = pool->freeList;
+        pool->freeList = block;
+    }
+
+    EndCriticalSection(savedmask);
+    return pool;
+}
+
+void * G8RTOS_PoolAlloc(pool_t * pool)
+{
+    void * block = 0;
+    uint32_t savedmask = StartCriticalSection();
+
+    if (pool->available.count > 0)          // free blocks promised to waiting threads do not count
+    {
+        pool->available.count--;
+        block = PopBlock(pool);
+    }
+    else
+    {
+        pool->failedAllocs++;
+    }
+
+    EndCriticalSection(savedmask);
+    return block;
+}
+
+void * G8RTOS_PoolAllocWait(pool_t * pool)
+{
+    G8RTOS_AcquireSemaphore(&pool->available);  // returns once a block is free and set aside for this thread
+
+    uint32_t savedmask = StartCriticalSection();
+    void * block = PopBlock(pool);
+    EndCriticalSection(savedmask);
+    return block;
+}
+
+int G8RTOS_PoolFree(pool_t * pool, void * block)
+{
+    if (!IsPoolBlock(pool, block))
+    {
+        return 1;       // RETURN ERROR (not a block of this pool)
+    }
+
+    uint32_t savedmask = StartCriticalSection();
+    if (pool->usedBlocks == 0)
+    {
+        EndCriticalSection(savedmask);
+        return 1;       // RETURN ERROR (double free, every block is already free)
+    }
+#if POOL_DOUBLE_FREE_CHECK
+    if (IsFreeBlock(pool, block))
+    {
+        EndCriticalSection(savedmask);
+        return 1;       // RETURN ERROR (double free)
+    }
+#endif
+    *(void **)block = pool->freeList;
+    pool->freeList = block;
+    pool->usedBlocks--;
+    G8RTOS_ReleaseSemaphore(&pool->available);
+    EndCriticalSection(savedmask);
+    return 0;
+}
+
+void G8RTOS_PoolGetStats(pool_t * pool, poolStats_t * stats)
+{
+    uint32_t savedmask = StartCriticalSection();
+    stats->blockSize = pool->blockSize;
+    stats->count = pool->count;
+    stats->usedBlocks = pool->usedBlocks;
+    stats->highWater = pool->highWater;
+    stats->failedAllocs = pool->failedAllocs;
+    EndCriticalSection(savedmask);
+}
+
+void G8RTOS_PoolResetStats(pool_t * pool)
+{
+    uint32_t savedmask = StartCriticalSection();
+    pool->highWater = pool->usedBlocks;
+    pool->failedAllocs = 0;
+    EndCriticalSection(savedmask);
+}
+
+uint32_t G8RTOS_PoolToMessage(pool_t * pool, void * block)
+{
+    uint32_t blockIndex = (uint32_t)((uint8_t *)block - pool->storage) / pool->blockSize;
+    return ((uint32_t)(pool - poolArray) << POOL_MESSAGE_SHIFT) | blockIndex;
+}
+
+void * G8RTOS_PoolFromMessage(uint32_t message)
+{
+    pool_t * pool = G8RTOS_PoolOfMessage(message);
+    if (!pool)
+    {
+        return 0;
+    }
+    return pool->storage + (message & POOL_MESSAGE_BLOCK_MASK) * pool->blockSize;
+}
+
+pool_t * G8RTOS_PoolOfMessage(uint32_t message)
+{
+    uint32_t poolIndex = message >> POOL_MESSAGE_SHIFT;
+    if (poolIndex >= MAX_POOLS || poolArray[poolIndex].count <= (message & POOL_MESSAGE_BLOCK_MASK))
+    {
+        return 0;
+    }
+    return &poolArray[poolIndex];
+}
+
+/*********************************************** Public Functions *********************************************************************/
@@ -0,0 +1,127 @@
+/*
+ * G8RTOS_Pool.h
+ *
+ * Fixed-block memory pools: constant time allocate/free of equal sized blocks from storage given by the application
+ */
+
+#ifndef G8RTOS_POOL_H_
+#define G8RTOS_POOL_H_
+
+/***************************************************** Includes ***********************************************************************/
+
+#include <stdint.h>
+#include "G8RTOS_Semaphores.h"
+
+/***************************************************** Includes ***********************************************************************/
+
+/*************************************************** Defines Used *********************************************************************/
+
+#define MAX_POOLS 4
+#ifndef POOL_DOUBLE_FREE_CHECK
+#define POOL_DOUBLE_FREE_CHECK 0    // 1: G8RTOS_PoolFree walks the free list to reject a block that is already free (debug builds)
+#endif
+
+/*
+ * Number of 32-bit words of storage a pool of count blocks of blockSize bytes needs
+ * Declare storage as: static uint32_t storage[G8RTOS_POOL_STORAGE_WORDS(blockSize, count)];
+ */
+#define G8RTOS_POOL_BLOCK_BYTES(blockSize) ((((blockSize) < sizeof(void *) ? sizeof(void *) : (blockSize)) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+#define G8RTOS_POOL_STORAGE_WORDS(blockSize, count) ((G8RTOS_POOL_BLOCK_BYTES(blockSize) * (count) + 3) / 4)
+
+/*************************************************** Defines Used *********************************************************************/
+
+/************************************************* Structures Used ********************************************************************/
+
+/*
+ * Pool typedef
+ *      - Free blocks are linked through their own first word (intrusive free list), so a pool needs no memory besides its blocks
+ *      - available counts the free blocks that are not promised to a waiting thread, blocking allocations wait on it
+ */
+typedef struct pool_t
+{
+    uint8_t * storage;
+    uint32_t blockSize;         // rounded up to a multiple of the pointer size
+    uint32_t count;
+    void * freeList;
+    uint32_t usedBlocks;
+    uint32_t highWater;
+    uint32_t failedAllocs;
+    semaphore_t available;
+} pool_t;
+
+/*
+ * Pool statistics
+ *      - usedBlocks: blocks allocated right now
+ *      - highWater: most blocks ever allocated at the same time
+ *      - failedAllocs: G8RTOS_PoolAlloc calls that found the pool empty
+ */
+typedef struct poolStats_t
+{
+    uint32_t blockSize;
+    uint32_t count;
+    uint32_t usedBlocks;
+    uint32_t highWater;
+    uint32_t failedAllocs;
+} poolStats_t;
+
+/*********************************************** Structures Used **********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Creates a pool of count blocks of blockSize bytes
+ *      - storage must be pointer aligned and G8RTOS_POOL_STORAGE_WORDS(blockSize, count) words long
+ *      - returns the pool, 0 if all MAX_POOLS pools are in use or blockSize/count is 0
+ */
+pool_t * G8RTOS_PoolCreate(uint32_t blockSize, uint32_t count, void * storage);
+
+/*
+ * Takes a block from a pool without blocking, safe to call from ISRs
+ *      - returns the block, 0 if no block is free
+ */
+void * G8RTOS_PoolAlloc(pool_t * pool);
+
+/*
+ * Takes a block from a pool, blocking the thread until one is freed if the pool is empty
+ *      - waiting threads get freed blocks highest priority first, like a semaphore
+ *      - must not be called from an ISR
+ */
+void * G8RTOS_PoolAllocWait(pool_t * pool);
+
+/*
+ * Gives a block back to its pool, safe to call from ISRs
+ *      - wakes the highest priority thread waiting in G8RTOS_PoolAllocWait
+ *      - a free while no block is allocated is rejected, with POOL_DOUBLE_FREE_CHECK any free of a block that is already free
+ *      - returns 0 on success, 1 if block is not an allocated block of this pool
+ */
+int G8RTOS_PoolFree(pool_t * pool, void * block);
+
+/*
+ * Copies the pool's usage statistics
+ */
+void G8RTOS_PoolGetStats(pool_t * pool, poolStats_t * stats);
+
+/*
+ * Clears the pool's high water mark (to the blocks in use now) and failed allocation count
+ */
+void G8RTOS_PoolResetStats(pool_t * pool);
+
+/*
+ * Encodes a block as a 32-bit message (pool number in the top byte, block number below) that fits in a FIFO word
+ *      - the message can be passed through G8RTOS_WriteFIFO/G8RTOS_ReadFIFO on every port, the block itself is not copied
+ */
+uint32_t G8RTOS_PoolToMessage(pool_t * pool, void * block);
+
+/*
+ * Returns the block a message from G8RTOS_PoolToMessage stands for, 0 if the message is not valid
+ */
+void * G8RTOS_PoolFromMessage(uint32_t message);
+
+/*
+ * Returns the pool a message from G8RTOS_PoolToMessage belongs to (to free the block with), 0 if the message is not valid
+ */
+pool_t * G8RTOS_PoolOfMessage(uint32_t message);
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_POOL_H_ */
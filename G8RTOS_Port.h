@@ -0,0 +1,134 @@
+/*
+ * G8RTOS_Port.h
+ *
+ * Everything the kernel needs from the target, so that G8RTOS_Scheduler.c, G8RTOS_Semaphores.c and
+ * G8RTOS_IPC.c compile unchanged on every port.
+ *      - MSP432 (default): G8RTOS_PortMSP432.c, G8RTOS_SchedulerASM.s, G8RTOS_CriticalSection.s
+ *      - POSIX host (define G8RTOS_PORT_POSIX): G8RTOS_PortPOSIX.c
+ */
+
+#ifndef G8RTOS_PORT_H_
+#define G8RTOS_PORT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(G8RTOS_PORT_POSIX)
+#include "G8RTOS_PortPOSIX.h"
+#else
+#include "msp.h"
+#include "BSP.h"
+
+/* Count leading zeros, used by the scheduler's ready bitmap (single instruction on the Cortex-M4) */
+#define G8RTOS_PORT_CLZ(x) __CLZ(x)
+
+/* Orders memory accesses before and after it, for data shared without a critical section (also a compiler barrier) */
+#define G8RTOS_PORT_MEMORY_BARRIER() __DMB()
+
+/*
+ * Adds to a shared word without a critical section (exclusive load/store, retried if anything else touched the word)
+ * Returns: Value of the word before the addition
+ */
+static inline uint32_t G8RTOS_PortAtomicFetchAdd(volatile uint32_t * word, uint32_t value)
+{
+    uint32_t old;
+    do
+    {
+        old = __LDREXW(word);
+    } while (__STREXW(old + value, word));
+    return old;
+}
+
+/*
+ * Stores desired into a shared word if it still holds expected, without a critical section
+ * Returns: true if the word was changed
+ */
+static inline bool G8RTOS_PortAtomicCompareExchange(volatile uint32_t * word, uint32_t expected, uint32_t desired)
+{
+    do
+    {
+        if (__LDREXW(word) != expected)
+        {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXW(desired, word));
+    return true;
+}
+
+/*
+ * Same as G8RTOS_PortAtomicCompareExchange for a shared pointer (pointers are 32 bits on the Cortex-M4)
+ */
+static inline bool G8RTOS_PortAtomicCompareExchangePointer(void * volatile * pointer, void * expected, void * desired)
+{
+    return G8RTOS_PortAtomicCompareExchange((volatile uint32_t *)pointer, (uint32_t)expected, (uint32_t)desired);
+}
+#endif
+
+#include "G8RTOS_CriticalSection.h"
+
+/*********************************************** Port Functions ***********************************************************************/
+
+/*
+ * Initializes the target before any thread is added
+ *  - MSP432: moves the vector table to SRAM and initializes the board
+ *  - POSIX: installs the tick and interrupt signal handlers, interrupts stay disabled until launch
+ */
+void G8RTOS_PortInit(void);
+
+/*
+ * Builds the initial context of a thread so that switching to it starts the thread function
+ * Param "stack": Lowest address of the thread's stack
+ * Param "stackWords": Size of the stack in 32-bit words
+ * Param "threadToAdd": Void-Void Function the thread starts in
+ * Returns: Value to store in the thread's tcb sp field
+ */
+int32_t * G8RTOS_PortInitStack(int32_t * stack, uint32_t stackWords, void (*threadToAdd)(void));
+
+/*
+ * Starts the 1ms tick that calls SysTick_Handler and sets the context switch to the lowest interrupt priority
+ */
+void G8RTOS_PortInitTick(void);
+
+/*
+ * Stops the tick for up to idleTicks ticks and waits for an interrupt
+ *  - Must be called with interrupts disabled, the interrupt that ends the wait runs once they are enabled again
+ *  - If the wait lasts the full idleTicks, the tick interrupt is left pending to count the last tick
+ * Param "idleTicks": Ticks until the next kernel event, must be at least 2
+ * Returns: Number of whole ticks that passed without a tick interrupt (to add to SystemTime)
+ */
+uint32_t G8RTOS_PortSuppressTicks(uint32_t idleTicks);
+
+/*
+ * Pends a context switch, taken as soon as no interrupt is running and interrupts are enabled
+ */
+void G8RTOS_PortYield(void);
+
+/*
+ * Installs an interrupt handler, sets its priority and enables it
+ */
+void G8RTOS_PortSetInterruptHandler(IRQn_Type IRQn, void (*handler)(void), uint8_t priority);
+
+/*
+ * Returns the interrupt number of the interrupt handler that is running, only valid inside one
+ */
+IRQn_Type G8RTOS_PortActiveInterrupt(void);
+
+/*
+ * Returns a free running cycle counter (DWT CYCCNT on MSP432, nanoseconds on the POSIX host)
+ */
+uint32_t G8RTOS_PortGetCycles(void);
+
+/*
+ * Returns the rate of G8RTOS_PortGetCycles in counts per second
+ */
+uint32_t G8RTOS_PortCyclesPerSecond(void);
+
+/*
+ * Loads the context of CurrentlyRunningThread and enables interrupts, never returns
+ */
+extern void G8RTOS_Start();
+
+/*********************************************** Port Functions ***********************************************************************/
+
+#endif /* G8RTOS_PORT_H_ */
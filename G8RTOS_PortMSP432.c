@@ -0,0 +1,224 @@
+/*
+ * G8RTOS_PortMSP432.c
+ *
+ * MSP432 (Cortex-M4F) port: SysTick tick, PendSV context switch, NVIC interrupts
+ * The context switch itself is PendSV_Handler in G8RTOS_SchedulerASM.s
+ */
+
+#if !defined(G8RTOS_PORT_POSIX)
+
+/*********************************************** Dependencies and Externs *************************************************************/
+#include <stdint.h>
+#include <string.h>
+#include "G8RTOS_Port.h"
+
+#define SHPR3 (*((volatile unsigned int *)(0xe000ed20)))
+#define PendSV_Priority (0xFF << 16)
+#define SysTick_Priority (0xFF << 24)
+
+/*
+ * System Core Clock From system_msp432p401r.c
+ */
+extern uint32_t SystemCoreClock;
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+
+/*********************************************** Defines ******************************************************************************/
+
+/* Status Register with the Thumb-bit Set */
+#define THUMBBIT 0x01000000
+
+/* EXC_RETURN of a thread that has not used the FPU: return to thread mode, main stack, basic frame */
+#define EXC_RETURN_NO_FPU 0xFFFFFFF9
+
+/* Number of words in the initial context: padding, R4-R11 and EXC_RETURN saved by PendSV, R0-R3, R12, LR, PC, PSR saved by hardware */
+#define INITIAL_CONTEXT_SIZE 18
+
+/*********************************************** Defines ******************************************************************************/
+
+
+/*********************************************** Private Variables ********************************************************************/
+
+/*
+ * Number of SysTick cycles in one 1ms tick
+ */
+static uint32_t CyclesPerTick;
+
+/*
+ * Longest number of ticks that can be suppressed (limited by the 24-bit SysTick reload)
+ */
+static uint32_t MaxSuppressedTicks;
+
+/*********************************************** Private Variables ********************************************************************/
+
+
+/*********************************************** Port Functions ***********************************************************************/
+
+/*
+ * Creates new vector table in SRAM so aperiodic events can be installed at run time
+ * Enables board for highest speed clock and disables watchdog
+ * Starts the DWT cycle counter
+ * Enables the FPU with automatic, lazy state preservation (S0-S15, FPSCR are only stored if the handler uses the FPU)
+ */
+void G8RTOS_PortInit(void)
+{
+    uint32_t newVTORTable = 0x20000000;
+    memcpy((uint32_t *)newVTORTable, (uint32_t *)SCB->VTOR, 57*4);  // 57 interrupt vectors to copy
+    SCB->VTOR = newVTORTable;
+    BSP_InitBoard();        // Initialize all hardware on the board
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    SCB->CPACR |= (3UL << 20) | (3UL << 22);                        // full access to CP10/CP11 (FPU)
+    FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
+    __DSB();
+    __ISB();
+}
+
+/* - Sets dummy values for the stack of a thread
+ * - R0-R3, R12, PC, LR, PSR get auto pushed onto stack (does not push SP)
+ * - sets PC to thread address
+ * - EXC_RETURN selects a basic frame, so a new thread has no FPU context until it executes its first FPU instruction
+ * - returns the stack pointer PendSV_Handler pops R3-R11 and EXC_RETURN from
+ */
+int32_t * G8RTOS_PortInitStack(int32_t * stack, uint32_t stackWords, void (*threadToAdd)(void))
+{
+    int32_t * top = stack + stackWords;
+
+    top[-1]  = THUMBBIT;                      // set thumb bit in PSR; PSR is auto pushed to the top of the stack
+    top[-2]  = (int32_t)(threadToAdd);        // set PC to new thread address
+    top[-3]  = 0x14141414;                    // R14/LR
+    top[-4]  = 0x12121212;                    // R12
+    top[-5]  = 0x03030303;                    // R3
+    top[-6]  = 0x02020202;                    // R2
+    top[-7]  = 0x01010101;                    // R1
+    top[-8]  = 0x00000000;                    // R0
+    top[-9]  = EXC_RETURN_NO_FPU;             // LR in PendSV
+    top[-10] = 0x0B0B0B0B;                    // R11
+    top[-11] = 0x0A0A0A0A;                    // R10
+    top[-12] = 0x09090909;                    // R9
+    top[-13] = 0x08080808;                    // R8
+    top[-14] = 0x07070707;                    // R7
+    top[-15] = 0x06060606;                    // R6
+    top[-16] = 0x05050505;                    // R5
+    top[-17] = 0x04040404;                    // R4
+    top[-18] = 0x03030303;                    // R3 (alignment padding)
+
+    return top - INITIAL_CONTEXT_SIZE;         // points to stack where core regs will be popped from in PendSV
+}
+
+/*
+ * Initializes the Systick and Systick Interrupt
+ * The Systick interrupt will be responsible for starting a context switch between threads
+ * Sets SysTick and PendSV to the lowest priority so they never preempt aperiodic events
+ */
+void G8RTOS_PortInitTick(void)
+{
+    CyclesPerTick = ClockSys_GetSysFreq()/1000;
+    MaxSuppressedTicks = SysTick_LOAD_RELOAD_Msk / CyclesPerTick;
+    SysTick_Config(CyclesPerTick);                              // set time quantum to 1ms
+    SysTick_enableInterrupt();
+    SHPR3 |= SysTick_Priority | PendSV_Priority | 0x0000;       // Set PendSV to high priority (low #)
+}
+
+/*
+ * Stops the 1ms tick for a number of ticks and sleeps until an interrupt arrives
+ *  - Reprograms SysTick to fire once at the end of the idle period, then sleeps with WFI
+ *  - Interrupts must be disabled (PRIMASK set): WFI still wakes on a pending interrupt, which runs once PRIMASK is cleared
+ *  - On wake up, SysTick is realigned to the tick boundary
+ */
+uint32_t G8RTOS_PortSuppressTicks(uint32_t idleTicks)
+{
+    if (idleTicks > MaxSuppressedTicks)
+    {
+        idleTicks = MaxSuppressedTicks;
+    }
+
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;                                     // stop the tick while it is reprogrammed
+    uint32_t sinceLastTick = CyclesPerTick - SysTick->VAL;                          // cycles already spent in the current tick
+    uint32_t idleCycles = SysTick->VAL + (idleTicks - 1) * CyclesPerTick;           // fire on the boundary of the last idle tick
+    SysTick->LOAD = idleCycles - 1;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+
+    __DSB();
+    __WFI();                                                                        // sleep until any interrupt is pending
+    __ISB();
+
+    uint32_t ctrl = SysTick->CTRL;                                                  // reading CTRL clears COUNTFLAG
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+    uint32_t nextTickCycles;
+    uint32_t completeTicks;
+
+    if (ctrl & SysTick_CTRL_COUNTFLAG_Msk)
+    {
+        // idle period ran out: the pending SysTick interrupt will count the last tick itself
+        uint32_t overshoot = (idleCycles - 1) - SysTick->VAL;
+        nextTickCycles = (overshoot < CyclesPerTick) ? CyclesPerTick - overshoot : CyclesPerTick;
+        completeTicks = idleTicks - 1;
+    }
+    else
+    {
+        // woken early by another interrupt: count the whole ticks that passed and finish the current one
+        uint32_t elapsed = sinceLastTick + (idleCycles - 1) - SysTick->VAL;
+        completeTicks = elapsed / CyclesPerTick;
+        nextTickCycles = (completeTicks + 1) * CyclesPerTick - elapsed;
+    }
+
+    SysTick->LOAD = nextTickCycles - 1;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+    SysTick->LOAD = CyclesPerTick - 1;                                              // used from the next reload onwards
+
+    return completeTicks;
+}
+
+/*
+ * Triggers a context switch by setting the PendSV flag
+ */
+void G8RTOS_PortYield(void)
+{
+    SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
+}
+
+/*
+ * Returns the DWT cycle counter
+ */
+uint32_t G8RTOS_PortGetCycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+/*
+ * Returns the core clock frequency
+ */
+uint32_t G8RTOS_PortCyclesPerSecond(void)
+{
+    return ClockSys_GetSysFreq();
+}
+
+/*
+ * Installs the handler in the SRAM vector table and enables the interrupt in the NVIC
+ */
+void G8RTOS_PortSetInterruptHandler(IRQn_Type IRQn, void (*handler)(void), uint8_t priority)
+{
+    __NVIC_SetVector(IRQn, (uint32_t)handler);
+    __NVIC_SetPriority(IRQn, priority);
+    __NVIC_EnableIRQ(IRQn);
+    P4->IFG &= ~BIT0;
+}
+
+/*
+ * Exception number in IPSR minus the 16 system exceptions
+ */
+IRQn_Type G8RTOS_PortActiveInterrupt(void)
+{
+    return (IRQn_Type)((int32_t)(__get_IPSR() & 0x1FF) - 16);
+}
+
+/*********************************************** Port Functions ***********************************************************************/
+
+#endif /* !G8RTOS_PORT_POSIX */
@@ -0,0 +1,400 @@
+/*
+ * G8RTOS_PortPOSIX.c
+ *
+ * POSIX host port, lets the kernel run as a single Linux process for benchmarking and simulation
+ *      - Each thread is a ucontext kept at the top of its stack, the tcb sp field points to it
+ *      - SIGALRM from a 1ms interval timer plays the SysTick, SIGUSR1 delivers injected interrupts
+ *      - "Interrupts disabled" means both signals are blocked, so the signal mask plays PRIMASK
+ *      - PendSV is emulated: a pended switch is taken when the last interrupt handler returns or
+ *        when interrupts are enabled again
+ */
+
+#if defined(G8RTOS_PORT_POSIX)
+
+#define _GNU_SOURCE
+
+/*********************************************** Dependencies and Externs *************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include "G8RTOS_Port.h"
+#include "G8RTOS_Scheduler.h"
+#include "G8RTOS_Structures.h"
+
+/*********************************************** Dependencies and Externs *************************************************************/
+
+
+/*********************************************** Defines ******************************************************************************/
+
+/* Number of interrupt numbers that can be injected */
+#define NUM_IRQS (PORT6_IRQn + 1)
+
+/* Signal used as the tick interrupt */
+#define TICK_SIGNAL SIGALRM
+
+/* Signal used to deliver injected interrupts */
+#define INTERRUPT_SIGNAL SIGUSR1
+
+/*********************************************** Defines ******************************************************************************/
+
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*
+ * What the tcb sp field points to: the thread's ucontext, and the function a new thread starts in
+ */
+typedef struct portContext_t
+{
+    ucontext_t context;
+    void (*entry)(void);
+} portContext_t;
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+
+/*********************************************** Private Variables ********************************************************************/
+
+/*
+ * Signals blocked by a critical section
+ */
+static sigset_t PortSignals;
+
+/*
+ * Number of interrupt handlers currently running (0 in thread context)
+ */
+static volatile uint32_t InterruptNesting;
+
+/*
+ * Set by G8RTOS_PortYield, cleared when the context switch is taken
+ */
+static volatile bool SwitchPending;
+
+/*
+ * Installed interrupt handlers and their priorities
+ */
+static void (*InterruptHandlers[NUM_IRQS])(void);
+static uint8_t InterruptPriorities[NUM_IRQS];
+
+/*
+ * One bit per interrupt number that has been triggered but not run yet
+ */
+static volatile uint64_t PendingInterrupts;
+
+/*
+ * Interrupt number of the injected interrupt whose handler is running
+ */
+static volatile IRQn_Type ActiveInterrupt;
+
+/*
+ * Tick interrupts delivered, see G8RTOS_PortTickInterrupts
+ */
+static volatile uint32_t TickInterrupts;
+
+/*********************************************** Private Variables ********************************************************************/
+
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Emulated PendSV_Handler
+ *  - Calls G8RTOS_Scheduler to get new tcb and swaps to its context
+ *  - Must be called with interrupts disabled and no interrupt handler running
+ *  - Returns once the thread that called it is switched back in
+ */
+static void PendSV(void)
+{
+    SwitchPending = false;
+
+    tcb_t * previousThread = CurrentlyRunningThread;
+    G8RTOS_Scheduler();
+    if (CurrentlyRunningThread != previousThread)
+    {
+        swapcontext((ucontext_t *)previousThread->sp, (ucontext_t *)CurrentlyRunningThread->sp);
+    }
+}
+
+/*
+ * Takes a pended context switch once the last interrupt handler returns
+ */
+static void InterruptExit(void)
+{
+    InterruptNesting--;
+    if (InterruptNesting == 0 && SwitchPending)
+    {
+        PendSV();
+    }
+}
+
+/*
+ * Tick signal handler, plays the SysTick interrupt
+ */
+static void TickSignalHandler(int signalNumber)
+{
+    (void)signalNumber;
+    InterruptNesting++;
+    TickInterrupts++;
+    SysTick_Handler();
+    InterruptExit();
+}
+
+/*
+ * Interrupt signal handler, runs every pending injected interrupt by priority (lowest # first)
+ */
+static void InterruptSignalHandler(int signalNumber)
+{
+    (void)signalNumber;
+    InterruptNesting++;
+    while (PendingInterrupts)
+    {
+        uint32_t irq = NUM_IRQS;
+        for (uint32_t i = 0; i < NUM_IRQS; i++)
+        {
+            if ((PendingInterrupts & (1ull << i)) && (irq == NUM_IRQS || InterruptPriorities[i] < InterruptPriorities[irq]))
+            {
+                irq = i;
+            }
+        }
+        __atomic_and_fetch(&PendingInterrupts, ~(1ull << irq), __ATOMIC_SEQ_CST);
+        if (InterruptHandlers[irq])
+        {
+            IRQn_Type interrupted = ActiveInterrupt;
+            ActiveInterrupt = (IRQn_Type)irq;
+            InterruptHandlers[irq]();
+            ActiveInterrupt = interrupted;
+        }
+    }
+    InterruptExit();
+}
+
+/*
+ * First function of every thread
+ *  - A new context starts with the signals blocked: swapcontext installs the new context's signal mask before it switches
+ *    stacks, so a new context with the signals unblocked would let a tick in on the old thread's stack in the middle of the switch
+ *  - Enables interrupts, then runs the thread's function
+ */
+static void ThreadStart(void)
+{
+    void (*entry)(void) = ((portContext_t *)CurrentlyRunningThread->sp)->entry;
+    EndCriticalSection(0);
+    entry();
+}
+
+/*
+ * Starts the 1ms interval timer
+ */
+static void StartTickTimer(void)
+{
+    struct itimerval tick = { { 0, 1000 }, { 0, 1000 } };
+    setitimer(ITIMER_REAL, &tick, 0);
+}
+
+/*
+ * Milliseconds between two monotonic clock readings
+ */
+static uint32_t ElapsedMilliseconds(struct timespec * start, struct timespec * end)
+{
+    return (uint32_t)((end->tv_sec - start->tv_sec) * 1000 + (end->tv_nsec - start->tv_nsec) / 1000000);
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+
+/*********************************************** Critical Sections ********************************************************************/
+
+/*
+ * Starts a critical section
+ * 	- Blocks the tick and interrupt signals
+ * Returns: 1 if they were already blocked (same meaning as the PRIMASK state on target)
+ */
+int32_t StartCriticalSection()
+{
+    sigset_t previous;
+    sigprocmask(SIG_BLOCK, &PortSignals, &previous);
+    return sigismember(&previous, TICK_SIGNAL);
+}
+
+/*
+ * Ends a critical section
+ * 	- Takes a pended context switch before unblocking the signals, like PendSV running once PRIMASK is cleared
+ * Param "IBit_State": State returned by the matching StartCriticalSection
+ */
+void EndCriticalSection(int32_t IBit_State)
+{
+    if (!IBit_State)
+    {
+        if (InterruptNesting == 0 && SwitchPending)
+        {
+            PendSV();
+        }
+        sigprocmask(SIG_UNBLOCK, &PortSignals, 0);
+    }
+}
+
+/*********************************************** Critical Sections ********************************************************************/
+
+
+/*********************************************** Port Functions ***********************************************************************/
+
+/*
+ * Installs the signal handlers and leaves interrupts disabled until the first thread starts
+ */
+void G8RTOS_PortInit(void)
+{
+    sigemptyset(&PortSignals);
+    sigaddset(&PortSignals, TICK_SIGNAL);
+    sigaddset(&PortSignals, INTERRUPT_SIGNAL);
+    sigprocmask(SIG_BLOCK, &PortSignals, 0);
+
+    struct sigaction action = { 0 };
+    action.sa_mask = PortSignals;           // interrupt handlers do not nest
+    action.sa_flags = SA_RESTART;
+    action.sa_handler = TickSignalHandler;
+    sigaction(TICK_SIGNAL, &action, 0);
+    action.sa_handler = InterruptSignalHandler;
+    sigaction(INTERRUPT_SIGNAL, &action, 0);
+
+    InterruptNesting = 0;
+    SwitchPending = false;
+    PendingInterrupts = 0;
+}
+
+/*
+ * Places the thread's context at the top of its stack, the rest of the stack is the ucontext's stack
+ *  - The thread starts in ThreadStart with interrupts disabled, which enables them before calling threadToAdd
+ */
+int32_t * G8RTOS_PortInitStack(int32_t * stack, uint32_t stackWords, void (*threadToAdd)(void))
+{
+    uintptr_t top = ((uintptr_t)(stack + stackWords) - sizeof(portContext_t)) & ~(uintptr_t)15;
+    portContext_t * context = (portContext_t *)top;
+
+    getcontext(&context->context);
+    sigaddset(&context->context.uc_sigmask, TICK_SIGNAL);
+    sigaddset(&context->context.uc_sigmask, INTERRUPT_SIGNAL);
+    context->context.uc_stack.ss_sp = stack;
+    context->context.uc_stack.ss_size = top - (uintptr_t)stack;
+    context->context.uc_link = 0;
+    context->entry = threadToAdd;
+    makecontext(&context->context, ThreadStart, 0);
+
+    return (int32_t *)context;
+}
+
+/*
+ * Starts the tick, it is delivered once the first thread enables interrupts
+ */
+void G8RTOS_PortInitTick(void)
+{
+    StartTickTimer();
+}
+
+/*
+ * Stops the interval timer and waits for the tick or an interrupt signal with sigtimedwait
+ *  - The signal that ends the wait is raised again so its handler runs once interrupts are enabled
+ */
+uint32_t G8RTOS_PortSuppressTicks(uint32_t idleTicks)
+{
+    struct itimerval stop = { { 0, 0 }, { 0, 0 } };
+    struct timespec start, end;
+    struct timespec timeout = { idleTicks / 1000, (idleTicks % 1000) * 1000000 };
+
+    setitimer(ITIMER_REAL, &stop, 0);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int signalNumber = sigtimedwait(&PortSignals, 0, &timeout);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    uint32_t completeTicks = ElapsedMilliseconds(&start, &end);
+    if (signalNumber < 0 || completeTicks >= idleTicks)
+    {
+        // idle period ran out: a tick interrupt counts the last tick itself
+        completeTicks = idleTicks - 1;
+        signalNumber = TICK_SIGNAL;
+    }
+    raise(signalNumber);
+
+    StartTickTimer();
+    return completeTicks;
+}
+
+/*
+ * Pends a context switch, taken right away when called from a thread with interrupts enabled
+ */
+void G8RTOS_PortYield(void)
+{
+    SwitchPending = true;
+    if (InterruptNesting == 0)
+    {
+        EndCriticalSection(StartCriticalSection());
+    }
+}
+
+/*
+ * Records the handler and priority of an injectable interrupt
+ */
+void G8RTOS_PortSetInterruptHandler(IRQn_Type IRQn, void (*handler)(void), uint8_t priority)
+{
+    InterruptHandlers[IRQn] = handler;
+    InterruptPriorities[IRQn] = priority;
+}
+
+/*
+ * Returns the injected interrupt whose handler is running
+ */
+IRQn_Type G8RTOS_PortActiveInterrupt(void)
+{
+    return ActiveInterrupt;
+}
+
+/*
+ * Returns the monotonic clock in nanoseconds, truncated to 32 bits
+ */
+uint32_t G8RTOS_PortGetCycles(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(now.tv_sec * 1000000000ull + now.tv_nsec);
+}
+
+/*
+ * Host "cycles" are nanoseconds
+ */
+uint32_t G8RTOS_PortCyclesPerSecond(void)
+{
+    return 1000000000;
+}
+
+/*
+ * Loads the context of CurrentlyRunningThread, its ThreadStart enables interrupts
+ */
+void G8RTOS_Start()
+{
+    setcontext((ucontext_t *)CurrentlyRunningThread->sp);
+}
+
+/*********************************************** Port Functions ***********************************************************************/
+
+
+/*********************************************** Host Functions ***********************************************************************/
+
+/*
+ * Marks the interrupt pending and delivers it with the interrupt signal
+ */
+void G8RTOS_PortTriggerInterrupt(IRQn_Type IRQn)
+{
+    __atomic_or_fetch(&PendingInterrupts, 1ull << IRQn, __ATOMIC_SEQ_CST);
+    raise(INTERRUPT_SIGNAL);
+}
+
+/*
+ * Returns the tick interrupts delivered since the process started
+ */
+uint32_t G8RTOS_PortTickInterrupts(void)
+{
+    return TickInterrupts;
+}
+
+/*********************************************** Host Functions ***********************************************************************/
+
+#endif /* G8RTOS_PORT_POSIX */
@@ -0,0 +1,131 @@
+/*
+ * G8RTOS_PortPOSIX.h
+ *
+ * POSIX host port, selected by defining G8RTOS_PORT_POSIX
+ *      - Threads are ucontexts, the context switch is swapcontext
+ *      - Interrupts are signals: SIGALRM is the 1ms tick, SIGUSR1 delivers injected interrupts
+ *      - A critical section blocks those signals
+ *      - Build with the kernel sources, G8RTOS_PortPOSIX.c and the application (no .s files)
+ */
+
+#ifndef G8RTOS_PORTPOSIX_H_
+#define G8RTOS_PORTPOSIX_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/* Host stacks also hold the ucontext and signal frames */
+#define STACKSIZE 8192
+#define MIN_STACKSIZE 4096
+#define STACK_ARENA_WORDS (MAX_THREADS * (STACKSIZE + 2))   // every thread can have a default stack (2 header words each)
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Interrupt numbers, same numbering as the MSP432 so applications compile unchanged
+ */
+typedef enum
+{
+    PSS_IRQn        = 0,
+    CS_IRQn         = 1,
+    PCM_IRQn        = 2,
+    WDT_A_IRQn      = 3,
+    FPU_IRQn        = 4,
+    FLCTL_IRQn      = 5,
+    COMP_E0_IRQn    = 6,
+    COMP_E1_IRQn    = 7,
+    TA0_0_IRQn      = 8,
+    TA0_N_IRQn      = 9,
+    TA1_0_IRQn      = 10,
+    TA1_N_IRQn      = 11,
+    TA2_0_IRQn      = 12,
+    TA2_N_IRQn      = 13,
+    TA3_0_IRQn      = 14,
+    TA3_N_IRQn      = 15,
+    EUSCIA0_IRQn    = 16,
+    EUSCIA1_IRQn    = 17,
+    EUSCIA2_IRQn    = 18,
+    EUSCIA3_IRQn    = 19,
+    EUSCIB0_IRQn    = 20,
+    EUSCIB1_IRQn    = 21,
+    EUSCIB2_IRQn    = 22,
+    EUSCIB3_IRQn    = 23,
+    ADC14_IRQn      = 24,
+    T32_INT1_IRQn   = 25,
+    T32_INT2_IRQn   = 26,
+    T32_INTC_IRQn   = 27,
+    AES256_IRQn     = 28,
+    RTC_C_IRQn      = 29,
+    DMA_ERR_IRQn    = 30,
+    DMA_INT3_IRQn   = 31,
+    DMA_INT2_IRQn   = 32,
+    DMA_INT1_IRQn   = 33,
+    DMA_INT0_IRQn   = 34,
+    PORT1_IRQn      = 35,
+    PORT2_IRQn      = 36,
+    PORT3_IRQn      = 37,
+    PORT4_IRQn      = 38,
+    PORT5_IRQn      = 39,
+    PORT6_IRQn      = 40
+} IRQn_Type;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*********************************************** Port Defines *************************************************************************/
+
+/* Count leading zeros, __builtin_clz is undefined for 0 */
+#define G8RTOS_PORT_CLZ(x) ((x) ? (uint32_t)__builtin_clz(x) : 32)
+
+/* Orders memory accesses before and after it, for data shared without a critical section */
+#define G8RTOS_PORT_MEMORY_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/*
+ * Adds to a shared word without a critical section
+ * Returns: Value of the word before the addition
+ */
+static inline uint32_t G8RTOS_PortAtomicFetchAdd(volatile uint32_t * word, uint32_t value)
+{
+    return __atomic_fetch_add(word, value, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Stores desired into a shared word if it still holds expected, without a critical section
+ * Returns: true if the word was changed
+ */
+static inline bool G8RTOS_PortAtomicCompareExchange(volatile uint32_t * word, uint32_t expected, uint32_t desired)
+{
+    return __atomic_compare_exchange_n(word, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Same as G8RTOS_PortAtomicCompareExchange for a shared pointer
+ */
+static inline bool G8RTOS_PortAtomicCompareExchangePointer(void * volatile * pointer, void * expected, void * desired)
+{
+    return __atomic_compare_exchange_n(pointer, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+/*********************************************** Port Defines *************************************************************************/
+
+/*********************************************** Host Functions ***********************************************************************/
+
+/*
+ * Raises an interrupt installed with G8RTOS_AddAPeriodicEvent
+ *  - Runs right away if interrupts are enabled, otherwise once the critical section ends
+ *  - Pending interrupts run lowest priority number first
+ */
+void G8RTOS_PortTriggerInterrupt(IRQn_Type IRQn);
+
+/*
+ * Returns the number of tick interrupts delivered so far
+ *  - Ticks skipped by tickless idle are not counted, so this against SystemTime gives the tick interrupts per simulated second
+ */
+uint32_t G8RTOS_PortTickInterrupts(void);
+
+/*********************************************** Host Functions ***********************************************************************/
+
+#endif /* G8RTOS_PORTPOSIX_H_ */
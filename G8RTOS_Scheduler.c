@@ -4,38 +4,25 @@
 
 /*********************************************** Dependencies and Externs *************************************************************/
 #include <stdint.h>
-#include "msp.h"
-#include "BSP.h"
+#include <string.h>
+#include "G8RTOS_Port.h"
 #include "G8RTOS_Scheduler.h"
 #include "G8RTOS_Structures.h"
-#include "G8RTOS_CriticalSection.h"
-
-#define SHPR3 (*((volatile unsigned int *)(0xe000ed20)))
-#define PendSV_Priority (0xFF << 16)
-#define SysTick_Priority (0xFF << 24)
-
-/*
- * G8RTOS_Start exists in asm
- */
-extern void G8RTOS_Start();
-
-/*
- * System Core Clock From system_msp432p401r.c
- */
-extern uint32_t SystemCoreClock;
-
-/*
- * Pointer to the currently running Thread Control Block
- */
-extern tcb_t * CurrentlyRunningThread;
+#include "G8RTOS_Timer.h"
+#include "G8RTOS_WorkQueue.h"
+#include "G8RTOS_Trace.h"
+#include "G8RTOS_IRQLatency.h"
 
 /*********************************************** Dependencies and Externs *************************************************************/
 
 
 /*********************************************** Defines ******************************************************************************/
 
-/* Status Register with the Thumb-bit Set */
-#define THUMBBIT 0x01000000
+/* Number of 32-bit words in the ready bitmap (one bit per priority level) */
+#define PRIORITY_GROUPS (PRIORITY_LEVELS / 32)
+
+/* Words in front of every block of the stack arena: block size in words (header included), 1 if the block is free */
+#define STACK_HEADER_WORDS 2
 
 /*********************************************** Defines ******************************************************************************/
 
@@ -52,11 +39,50 @@ static tcb_t threadControlBlocks[MAX_THREADS];
  */
 static ptcb_t periodicThreadControlBlocks[MAX_PERIODIC_THREADS];
 
+/* Periodic Thread Heap
+ *  - Min-heap of periodic thread control blocks ordered by executeTime, the root is the next release
+ */
+static ptcb_t * periodicHeap[MAX_PERIODIC_THREADS];
+
+
+/* Stack Arena
+ *	- All thread stacks are carved out of this array, each block starts with a STACK_HEADER_WORDS header
+ *	- Blocks cover the whole arena back to back, free neighbours are merged when a stack is freed
+ *	- Declared as 64-bit words so every stack is 8-byte aligned
+ */
+static uint64_t stackArena[STACK_ARENA_WORDS / 2];
+
+/* Ready Lists
+ *  - One circular list of ready threads per priority level, the head is the next thread to run at that level
+ *  - readyMap[g] has bit (31 - (priority & 31)) set while priority (32 * g + priority & 31) has a ready thread
+ *  - readyGroups has bit (31 - g) set while readyMap[g] is non-zero
+ *  - Bits are stored reversed so count leading zeros gives the highest priority (lowest number) directly
+ */
+static tcb_t * readyLists[PRIORITY_LEVELS];
+static uint32_t readyMap[PRIORITY_GROUPS];
+static uint32_t readyGroups;
+
+/* Sleeping Threads
+ *  - Doubly linked list of sleeping threads sorted by wake up time (sleepCount), earliest first
+ *  - The SysTick only has to look at the head to know whether anything wakes up this tick
+ */
+static tcb_t * sleepingThreads;
 
-/* Thread Stacks
- *	- An array of arrays that will act as individual stacks for each thread
+/* Admission Set
+ *  - Real-time threads G8RTOS_AddRealTimeThread tests for schedulability: the ones alive plus the one being added (thread 0)
+ *  - wcet in microseconds, period and deadline in ms, priority as the thread would run at
  */
-static int32_t threadStacks[MAX_THREADS][STACKSIZE];
+typedef struct realTimeTask_t
+{
+    tcb_t * thread;
+    uint32_t wcet;
+    uint32_t period;
+    uint32_t deadline;
+    uint8_t priority;
+} realTimeTask_t;
+
+static realTimeTask_t admissionSet[MAX_THREADS];
+static uint32_t admissionCount;
 
 /*********************************************** Data Structures Used *****************************************************************/
 
@@ -74,9 +100,56 @@ static uint32_t NumberOfThreads;
 static uint32_t NumberOfPeriodicThreads;
 
 /*
- * Increments to set unique ID for each thread
+ * Indices of the thread control blocks that are free, the last one is handed out first
+ */
+static uint8_t freeThreadSlots[MAX_THREADS];
+static uint32_t NumberOfFreeSlots;
+
+/*
+ * Released by the SysTick when the root of the periodic heap is due, the periodic kernel thread waits on it
+ */
+static semaphore_t periodicRelease;
+
+/*
+ * Set once the periodic kernel thread has been added, it stays when the last periodic thread is removed
+ */
+static bool periodicThreadAdded;
+
+/*
+ * Thread that killed itself, its stack and thread control block are freed by the scheduler once it no longer runs on them
+ */
+static tcb_t * deadThread;
+
+/*
+ * Runtime statistics (THREAD_STATS)
+ *  - lastSwitchCycles: cycle count the running thread has been charged up to
+ *  - windowStartCycles / windowEndTime: cycle count and system time of the start and end of the current statistics window
+ *  - windowLength: cycles of the last complete statistics window
+ *  - tickCycles: cycles spent in the SysTick handler
+ */
+static uint32_t lastSwitchCycles;
+static uint32_t windowStartCycles;
+static uint32_t windowEndTime;
+static uint32_t windowLength;
+static uint64_t tickCycles;
+
+/*
+ * Thread control block of the built-in idle thread
+ */
+static tcb_t * idleThread;
+
+/*
+ * Thread control block the last successful G8RTOS_AddThreadStack call initialized
+ */
+static tcb_t * addedThread;
+
+/*
+ * Job statistics (JOB_STATS)
+ *  - tickStartCycles: cycle count at the start of the last SysTick, release times are measured from it
+ *  - deadlineMissCallback: see G8RTOS_SetDeadlineMissCallback
  */
-static uint16_t IDCounter;
+static uint32_t tickStartCycles;
+static void (*deadlineMissCallback)(void (*job)(void), uint32_t lateness);
 
 /*********************************************** Private Variables ********************************************************************/
 
@@ -84,313 +157,1267 @@ static uint16_t IDCounter;
 /*********************************************** Private Functions ********************************************************************/
 
 /*
- * Initializes the Systick and Systick Interrupt
- * The Systick interrupt will be responsible for starting a context switch between threads
- * Param "numCycles": Number of cycles for each systick interrupt
+ * Returns the highest priority (lowest #) that has a ready thread
+ *  - Two count leading zeros lookups on the ready bitmap, independent of the number of threads
+ *  - readyGroups must be non-zero
  */
-static void InitSysTick(void)
+static uint32_t HighestReadyPriority(void)
 {
-    SysTick_Config(ClockSys_GetSysFreq()/1000);     // set time quantum to 1ms
-    SysTick_enableInterrupt();
+    uint32_t group = G8RTOS_PORT_CLZ(readyGroups);
+    return (group << 5) | G8RTOS_PORT_CLZ(readyMap[group]);
 }
 
 /*
- * Chooses the next thread to run.
- * Scheduling Algorithm:
- * 	- Priority Round Robin: Choose the next running thread by selecting the next thread with the lowest # priority (highest prio)
- * 	- If scheduler finds that next running thread is asleep or blocked, tries next thread
+ * Inserts a thread into the sleeping list in wake up order
+ *  - Threads waking at the same time keep the order they went to sleep in
+ *  - Times are compared as a signed difference so SystemTime wrapping around is handled
+ *  - Must be called inside a critical section
  */
-void G8RTOS_Scheduler()
+static void InsertSleepingThread(tcb_t * thread)
 {
-    uint8_t currentMaxPriority = 255;
+    tcb_t * prev = 0;
+    tcb_t * next = sleepingThreads;
 
-    tcb_t * tempNextThread = CurrentlyRunningThread->next;
+    while (next && (int32_t)(next->sleepCount - thread->sleepCount) <= 0)
+    {
+        prev = next;
+        next = next->sleepNext;
+    }
 
-    for(int i = 0; i < NumberOfThreads; i++)
+    thread->sleepPrev = prev;
+    thread->sleepNext = next;
+    if (next)
     {
-        if(!(tempNextThread->asleep) && !(tempNextThread->blocked))
-        {
-            if(tempNextThread->priority < currentMaxPriority)
-            {
-                CurrentlyRunningThread = tempNextThread;
-                currentMaxPriority = tempNextThread->priority;
-            }
-        }
-        tempNextThread = tempNextThread->next;
+        next->sleepPrev = thread;
+    }
+    if (prev)
+    {
+        prev->sleepNext = thread;
+    }
+    else
+    {
+        sleepingThreads = thread;
     }
 }
 
 /*
- * SysTick Handler
+ * Removes a thread from the sleeping list
+ *  - Must be called inside a critical section
  */
-void SysTick_Handler()
+static void RemoveSleepingThread(tcb_t * thread)
 {
-    SystemTime++;
+    if (thread->sleepNext)
+    {
+        thread->sleepNext->sleepPrev = thread->sleepPrev;
+    }
+    if (thread->sleepPrev)
+    {
+        thread->sleepPrev->sleepNext = thread->sleepNext;
+    }
+    else
+    {
+        sleepingThreads = thread->sleepNext;
+    }
 
-    // PERIODIC THREADS - run periodic threads at their execute time
-    if (NumberOfPeriodicThreads > 0)
+    thread->sleepNext = 0;
+    thread->sleepPrev = 0;
+}
+
+/*
+ * Takes a blocked thread off the object it waits on, without making it ready
+ *  - A semaphore gets back the count the waiting thread took
+ *  - Mutex waits are taken apart by G8RTOS_AbandonMutexes, which also fixes up the owner's inherited priority
+ *  - Must be called inside a critical section
+ */
+static void CancelWait(tcb_t * thread)
+{
+    waitObject_t * w = thread->blocked;
+    G8RTOS_RemoveFromWaitList(&w->waiters, thread);
+    if (w->type == WAIT_SEMAPHORE)
+    {
+        ((semaphore_t *)w)->count++;                    // the thread no longer waits on it
+    }
+    thread->blocked = 0;
+}
+
+/*
+ * Makes the whole stack arena one free block
+ */
+static void InitStackArena(void)
+{
+    int32_t * arena = (int32_t *)stackArena;
+    arena[0] = (STACK_ARENA_WORDS / 2) * 2;
+    arena[1] = 1;
+}
+
+/*
+ * Takes a stack from the first free block of the arena that is large enough
+ *  - Splits the block if the rest is large enough for another stack
+ *  - Must be called inside a critical section
+ * Returns: Lowest address of the stack, 0 if no free block is large enough
+ */
+static int32_t * AllocateStack(uint32_t stackWords)
+{
+    int32_t * arena = (int32_t *)stackArena;
+    int32_t blockWords = stackWords + STACK_HEADER_WORDS;
+
+    for (uint32_t i = 0; i < (STACK_ARENA_WORDS / 2) * 2; i += arena[i])
     {
-        ptcb_t * pPtr = &periodicThreadControlBlocks[0];
-        for (int i = 0 ; i < NumberOfPeriodicThreads ; i++)
+        if (arena[i + 1] && arena[i] >= blockWords)
         {
-            if (SystemTime >= pPtr->executeTime)
+            if (arena[i] - blockWords >= STACK_HEADER_WORDS + MIN_STACKSIZE)
             {
-                pPtr->executeTime = SystemTime + pPtr->period;      // new execute time is 1 period from current time
-                pPtr->handler();                                    // execute the code at the handler
+                arena[i + blockWords] = arena[i] - blockWords;
+                arena[i + blockWords + 1] = 1;
+                arena[i] = blockWords;
             }
-            pPtr = pPtr->next;
+            arena[i + 1] = 0;
+            return &arena[i + STACK_HEADER_WORDS];
         }
     }
+    return 0;
+}
+
+/*
+ * Gives a stack back to the arena and merges free blocks that are next to each other
+ *  - Must be called inside a critical section
+ */
+static void FreeStack(int32_t * stack)
+{
+    int32_t * arena = (int32_t *)stackArena;
+    stack[-STACK_HEADER_WORDS + 1] = 1;
 
-    // SLEEPING THREADS - check to see if the NEXT thread is asleep and if it is time to wake it up (sleep count = system time)
-    tcb_t * nextThread = CurrentlyRunningThread->next;
-    for (int i = 0 ; i < MAX_THREADS ; i++)
+    for (uint32_t i = 0; i < (STACK_ARENA_WORDS / 2) * 2; i += arena[i])
     {
-        if ((nextThread->asleep) && (nextThread->sleepCount <= SystemTime))
+        while (arena[i + 1] && i + arena[i] < (STACK_ARENA_WORDS / 2) * 2 && arena[i + arena[i] + 1])
         {
-            nextThread->asleep = false;     // wake up thread
+            arena[i] += arena[i + arena[i]];
         }
-        nextThread = nextThread->next;
     }
-
-    // Trigger context switch
-    G8RTOS_Yield();
-
 }
 
-void G8RTOS_Yield()
+/*
+ * Returns the index of the alive thread with the given ID, MAX_THREADS if there is none
+ *  - The low 16 bits of an ID are the thread control block index, the high 16 bits count how often that block was reused,
+ *    so the ID of a killed thread no longer matches once its block is reused
+ */
+static uint32_t ThreadIndex(threadId_t threadId)
 {
-    SCB->ICSR |= SCB_ICSR_PENDSVSET_Msk;
+    uint32_t index = threadId & 0xFFFF;
+    if (index < MAX_THREADS && threadControlBlocks[index].alive && threadControlBlocks[index].threadID == threadId)
+    {
+        return index;
+    }
+    return MAX_THREADS;
 }
 
-/*********************************************** Private Functions ********************************************************************/
-
+/*
+ * Gives the stack and thread control block of a killed thread back
+ *  - An interrupt latency measurement still waiting for the thread to run is dropped
+ *  - Must be called inside a critical section, once the thread is no longer running
+ */
+static void FreeThread(tcb_t * thread)
+{
+    G8RTOS_IRQ_LATENCY_FORGET(thread);
+    FreeStack(thread->stackBase);
+    freeThreadSlots[NumberOfFreeSlots++] = thread - threadControlBlocks;
+}
 
-/*********************************************** Public Variables *********************************************************************/
+#if THREAD_STATS
+/*
+ * Ends the current statistics window
+ *  - The running thread is charged up to now first
+ *  - Every thread's cycles since the last window are kept in windowCycles for its CPU percentage
+ *  - Must be called inside a critical section
+ */
+static void CloseStatsWindow(uint32_t now)
+{
+    CurrentlyRunningThread->runCycles += now - lastSwitchCycles;
+    lastSwitchCycles = now;
 
-/* Holds the current time for the whole System */
-uint32_t SystemTime;
+    windowLength = now - windowStartCycles;
+    windowStartCycles = now;
+    windowEndTime = SystemTime + STATS_WINDOW_MS;
 
-/*********************************************** Public Variables *********************************************************************/
+    for (uint32_t i = 0; i < MAX_THREADS; i++)
+    {
+        tcb_t * thread = &threadControlBlocks[i];
+        thread->windowCycles = (uint32_t)(thread->runCycles - thread->windowStart);
+        thread->windowStart = thread->runCycles;
+    }
+}
+#endif
 
+/*
+ * Returns the share of the last statistics window a thread ran for, in percent
+ */
+static uint8_t WindowPercent(tcb_t * thread)
+{
+    if (windowLength == 0)
+    {
+        return 0;
+    }
+    uint64_t percent = (uint64_t)thread->windowCycles * 100 / windowLength;
+    return percent > 100 ? 100 : (uint8_t)percent;
+}
 
-/*********************************************** Public Functions *********************************************************************/
+#if JOB_STATS
+/*
+ * Converts a cycle count of G8RTOS_PortGetCycles into microseconds
+ */
+static uint32_t CyclesToMicros(uint32_t cycles)
+{
+    return (uint32_t)((uint64_t)cycles * 1000000 / G8RTOS_PortCyclesPerSecond());
+}
 
 /*
- * Sets variables to an initial state (system time and number of threads)
- * Enables board for highest speed clock and disables watchdog
+ * Returns the microseconds from the start of the tick at system time "time" until now
+ *  - time must not be later than SystemTime
+ *  - Must be called inside a critical section
  */
-void G8RTOS_Init()
+static uint32_t MicrosSince(uint32_t time)
 {
-    // Set vars to initial state
-    SystemTime = 0;         // Set system time to initial value of 0
-    NumberOfThreads = 0;    // Set number of threads to initial value of 0
-    NumberOfPeriodicThreads = 0;
-    IDCounter = 0;
-    CurrentlyRunningThread = &threadControlBlocks[0];
-    // Create new vector table in SRAM
-    uint32_t newVTORTable = 0x20000000;
-    memcpy((uint32_t *)newVTORTable, (uint32_t *)SCB->VTOR, 57*4);  // 57 interrupt vectors to copy
-    SCB->VTOR = newVTORTable;
-    BSP_InitBoard();        // Initialize all hardware on the board
+    return (SystemTime - time) * 1000 + CyclesToMicros(G8RTOS_PortGetCycles() - tickStartCycles);
 }
 
 /*
- * Starts G8RTOS Scheduler
- * 	- Initializes the Systick
- * 	- Sets Context to first thread
- * Returns: Error Code for starting scheduler. This will only return if the scheduler fails
+ * Returns a cycle count that only advances while the running thread runs (THREAD_STATS), or the plain cycle count
+ *  - Must be called inside a critical section
  */
-int G8RTOS_Launch()
+static uint32_t JobCycles(void)
 {
-    uint8_t currentMaxPriority = 255;
+#if THREAD_STATS
+    return (uint32_t)CurrentlyRunningThread->runCycles + (G8RTOS_PortGetCycles() - lastSwitchCycles);
+#else
+    return G8RTOS_PortGetCycles();
+#endif
+}
 
-    tcb_t * tempNextThread = &threadControlBlocks[0];
+/*
+ * Returns the histogram bucket of a time in microseconds, log2 of it rounded down plus one, 0 for 0
+ */
+static uint32_t HistogramBucket(uint32_t micros)
+{
+    uint32_t bucket = micros ? 32 - G8RTOS_PORT_CLZ(micros) : 0;
+    return bucket < JOB_HISTOGRAM_BUCKETS ? bucket : JOB_HISTOGRAM_BUCKETS - 1;
+}
 
-    for(int i = 0; i < NumberOfThreads; i++)                // sets CurrentlyRunningThread to highest priority thread in list
+/*
+ * Records a job that just completed, and calls the deadline miss callback if it completed at or after its deadline
+ *  - owner points at the function field of the ptcb or tcb the stats belong to: G8RTOS_RemovePeriodicThread can move
+ *    another periodic thread into the ptcb while the job runs, its stats are then left alone
+ *  - latency and startCycles were taken right before the job started, deadline is a system time, budget is in microseconds
+ */
+static void RecordJob(jobStats_t * stats, void (* const * owner)(void), void (*job)(void), uint32_t latency,
+                      uint32_t startCycles, uint32_t deadline, uint32_t budget)
+{
+    uint32_t savedmask = StartCriticalSection();
+    uint32_t execution = CyclesToMicros(JobCycles() - startCycles);
+    bool missed = (int32_t)(SystemTime - deadline) >= 0;
+    uint32_t lateness = missed ? MicrosSince(deadline) : 0;
+    if (*owner == job)
     {
-        if(tempNextThread->priority < currentMaxPriority)
-        {
-            CurrentlyRunningThread = tempNextThread;
-            currentMaxPriority = tempNextThread->priority;
-        }
+        stats->jobs++;
+        stats->misses += missed;
+        stats->overruns += execution > budget;
+        stats->maxLatency = latency > stats->maxLatency ? latency : stats->maxLatency;
+        stats->maxExecution = execution > stats->maxExecution ? execution : stats->maxExecution;
+        stats->latency[HistogramBucket(latency)]++;
+        stats->execution[HistogramBucket(execution)]++;
     }
+    EndCriticalSection(savedmask);
 
-    InitSysTick();                                              // Initialize SysTick
-    SHPR3 |= SysTick_Priority | PendSV_Priority | 0x0000;       // Set PendSV to high priority (low #)
-    G8RTOS_Start();
-    return 1;   //RETURN ERROR: should not return from Start function
+    if (missed && deadlineMissCallback)
+    {
+        deadlineMissCallback(job, lateness);
+    }
 }
-
+#endif
 
 /*
- * Adds threads to G8RTOS Scheduler
- * 	- Checks if there are still available threads to insert to scheduler
- * 	- Initializes the thread control block for the provided thread
- * 	- Initializes the stack for the provided thread to hold a "fake context"
- * 	- Sets stack tcb stack pointer to top of thread stack
- * 	- Sets up the next and previous tcb pointers in a round robin fashion
- * Param "threadToAdd": Void-Void Function to add as preemptable main thread
- * Returns: Error code for adding threads
+ * Returns true if periodic thread a is released before periodic thread b
  */
-sched_ErrCode_t G8RTOS_AddThread(void (*threadToAdd)(void), uint8_t priority, char* threadname)
+static bool ReleasedBefore(ptcb_t * a, ptcb_t * b)
 {
-    uint32_t savedmask = StartCriticalSection(); // disable interrupts (start critical section)
+    return (int32_t)(a->executeTime - b->executeTime) < 0;
+}
 
-    uint32_t tcbToInitialize = MAX_THREADS;
-    for(int i = 0; i < MAX_THREADS; i++)
+/*
+ * Moves a periodic heap entry up until its parent is released before it
+ */
+static void PeriodicHeapSiftUp(uint32_t index)
+{
+    ptcb_t * entry = periodicHeap[index];
+    while (index > 0 && ReleasedBefore(entry, periodicHeap[(index - 1) / 2]))
     {
-        if(!threadControlBlocks[i].alive)
-        {
-            tcbToInitialize = i;
-            break;
-        }
+        periodicHeap[index] = periodicHeap[(index - 1) / 2];
+        index = (index - 1) / 2;
     }
+    periodicHeap[index] = entry;
+}
 
-    if (tcbToInitialize < MAX_THREADS)  // Checks if there are still available threads to insert to scheduler
+/*
+ * Moves a periodic heap entry down until both children are released after it
+ */
+static void PeriodicHeapSiftDown(uint32_t index)
+{
+    ptcb_t * entry = periodicHeap[index];
+    while (2 * index + 1 < NumberOfPeriodicThreads)
     {
-        setInitialStack(threadToAdd, tcbToInitialize);                                               // initialize fake context for new thread
-        threadControlBlocks[tcbToInitialize].sp = &threadStacks[tcbToInitialize][STACKSIZE-16];   // points to stack where core regs will be popped from in PendSV
-        if (NumberOfThreads == 0)
+        uint32_t child = 2 * index + 1;
+        if (child + 1 < NumberOfPeriodicThreads && ReleasedBefore(periodicHeap[child + 1], periodicHeap[child]))
         {
-            threadControlBlocks[0].next = &threadControlBlocks[0];              // Next is set to current TCB
-            threadControlBlocks[0].prev = &threadControlBlocks[0];              // Prev is set to current TCB
+            child++;
         }
-        else
+        if (!ReleasedBefore(periodicHeap[child], entry))
         {
-            threadControlBlocks[tcbToInitialize].prev = CurrentlyRunningThread;
-            threadControlBlocks[tcbToInitialize].next = CurrentlyRunningThread->next;
-            threadControlBlocks[tcbToInitialize].next->prev = &threadControlBlocks[tcbToInitialize];
-            CurrentlyRunningThread->next = &threadControlBlocks[tcbToInitialize];
+            break;
         }
+        periodicHeap[index] = periodicHeap[child];
+        index = child;
+    }
+    periodicHeap[index] = entry;
+}
 
-        threadControlBlocks[tcbToInitialize].asleep = false;
-        threadControlBlocks[tcbToInitialize].priority = priority;
-        threadControlBlocks[tcbToInitialize].threadID = ((IDCounter++) << 16 | tcbToInitialize);
-        threadControlBlocks[tcbToInitialize].alive = true;
-        strcpy(threadControlBlocks[tcbToInitialize].threadName, threadname);
+/*
+ * Returns true if the next periodic release has been reached
+ *  - Must be called inside a critical section
+ */
+static bool PeriodicThreadDue(void)
+{
+    return NumberOfPeriodicThreads > 0 && (int32_t)(SystemTime - periodicHeap[0]->executeTime) >= 0;
+}
 
-        NumberOfThreads++;
-        EndCriticalSection(savedmask);                  // enable interrupts (end critical section)
-        return NO_ERROR;
-    }
-    else
+/*
+ * Periodic kernel thread, runs at PERIODIC_THREAD_PRIORITY
+ *  - Waits until the SysTick signals that the root of the periodic heap is due
+ *  - Runs every due periodic thread in release order, outside of any interrupt
+ *  - Next release is the previous release plus the period, so a late start does not shift later releases
+ *  - With JOB_STATS every job's latency from its release and execution time are recorded, its deadline is the next release
+ */
+static void PeriodicThread(void)
+{
+    while(1)
     {
-        EndCriticalSection(savedmask);                  // enable interrupts (end critical section)
-        return THREADS_INCORRECTLY_ALIVE;       // RETURN ERROR (cannot have greater than MAX_THREADS threads)
+        G8RTOS_AcquireSemaphore(&periodicRelease);
+
+        uint32_t savedmask = StartCriticalSection();
+        while (PeriodicThreadDue())
+        {
+            ptcb_t * ptcb = periodicHeap[0];
+            void (*handler)(void) = ptcb->handler;
+#if JOB_STATS
+            uint32_t release = ptcb->executeTime;
+            uint32_t period = ptcb->period;
+            uint32_t latency = MicrosSince(release);
+            uint32_t startCycles = JobCycles();
+#endif
+            ptcb->executeTime += ptcb->period;
+            PeriodicHeapSiftDown(0);
+            EndCriticalSection(savedmask);
+
+            handler();                                          // execute the code at the handler
+
+#if JOB_STATS
+            RecordJob(&ptcb->jobStats, &ptcb->handler, handler, latency, startCycles, release + period, period * 1000);
+#endif
+            savedmask = StartCriticalSection();
+        }
+        EndCriticalSection(savedmask);
     }
 }
 
 /*
- * Adds periodic threads to G8RTOS Scheduler
- *  - Checks if there are still available threads to insert to scheduler
- *  - Initializes the thread control block for the provided thread
- *  - Initializes the stack for the provided thread to hold a "fake context"
- *  - Sets stack tcb stack pointer to top of thread stack
- *  - Sets up the next and previous tcb pointers in a round robin fashion
- * Param "threadToAdd": Void-Void Function to add as preemptable main thread
- * Returns: Error code for adding threads
+ * Real-time thread, every thread added with G8RTOS_AddRealTimeThread runs this
+ *  - Runs the thread's job, then sleeps until the next release, one period after the previous one
+ *  - If the next release has already passed, the next job starts right away; it is queued again by its new deadline
+ *  - With JOB_STATS every job's latency from its release and execution time are recorded, its budget is the declared wcet
  */
-int G8RTOS_AddPeriodicThread(void (*threadToAdd)(void), uint32_t period)
+static void RealTimeThread(void)
 {
-    uint32_t savedmask = StartCriticalSection(); // disable interrupts (start critical section)
-    if (NumberOfPeriodicThreads < MAX_PERIODIC_THREADS)
+    tcb_t * self = CurrentlyRunningThread;
+    while(1)
     {
-        // initialize periodic tcb for new periodic thread
-        periodicThreadControlBlocks[NumberOfPeriodicThreads].handler = threadToAdd;
-        periodicThreadControlBlocks[NumberOfPeriodicThreads].period = period;
-        periodicThreadControlBlocks[NumberOfPeriodicThreads].currentTime = SystemTime;
+        uint32_t savedmask;
+#if JOB_STATS
+        savedmask = StartCriticalSection();
+        uint32_t latency = MicrosSince(self->release);
+        uint32_t startCycles = JobCycles();
+        EndCriticalSection(savedmask);
+#endif
 
-        if (NumberOfPeriodicThreads == 0)
+        self->job();
+
+#if JOB_STATS
+        RecordJob(&self->jobStats, &self->job, self->job, latency, startCycles, self->absoluteDeadline, self->wcet);
+#endif
+        savedmask = StartCriticalSection();
+        self->release += self->period;
+        self->absoluteDeadline = self->release + self->relativeDeadline;
+        G8RTOS_RemoveFromReadyList(self);
+        if ((int32_t)(self->release - SystemTime) > 0)
         {
-            periodicThreadControlBlocks[NumberOfPeriodicThreads].executeTime = SystemTime + period;
-            periodicThreadControlBlocks[0].next = &periodicThreadControlBlocks[0];
-            periodicThreadControlBlocks[0].prev = &periodicThreadControlBlocks[0];
+            self->sleepCount = self->release;
+            self->asleep = true;
+            InsertSleepingThread(self);
         }
-        else if (NumberOfPeriodicThreads > 0)
+        else
         {
-            periodicThreadControlBlocks[NumberOfPeriodicThreads].executeTime = SystemTime + period + 1 + NumberOfPeriodicThreads;
-            periodicThreadControlBlocks[0].prev = &periodicThreadControlBlocks[NumberOfPeriodicThreads];
-            periodicThreadControlBlocks[NumberOfPeriodicThreads-1].next = &periodicThreadControlBlocks[NumberOfPeriodicThreads];
-            periodicThreadControlBlocks[NumberOfPeriodicThreads].prev = &periodicThreadControlBlocks[NumberOfPeriodicThreads-1];
-            periodicThreadControlBlocks[NumberOfPeriodicThreads].next = &periodicThreadControlBlocks[0];
+            G8RTOS_AddToReadyList(self);
         }
-        else {
-            EndCriticalSection(savedmask);                  // enable interrupts (end critical section)
-            return 1;   // RETURN ERROR (impossible negative NumberOfPeriodicThreads value)
-        }
-
-        NumberOfPeriodicThreads++;
-        EndCriticalSection(savedmask);                  // enable interrupts (end critical section)
-        return 0;
-    }
-    else
-    {
-        EndCriticalSection(savedmask);                  // enable interrupts (end critical section)
-        return 1;       // RETURN ERROR (cannot have greater than MAX_PERIODIC_THREADS periodic threads)
+        EndCriticalSection(savedmask);
+        G8RTOS_Yield();
     }
 }
 
+#if SCHED_POLICY == SCHED_POLICY_RM
 /*
- * Adds aperiodic event to G8RTOS Scheduler
+ * Returns true if real-time task a gets a higher rate-monotonic priority than task b
+ *  - Shorter period first, then shorter deadline, then the task that was admitted first
  */
-sched_ErrCode_t G8RTOS_AddAPeriodicEvent(void (*AthreadToAdd) (void), uint8_t priority, IRQn_Type IRQn)
+static bool RateMonotonicBefore(uint32_t a, uint32_t b)
 {
-    uint32_t savedmask = StartCriticalSection();
-    if( IRQn < PSS_IRQn || IRQn > PORT6_IRQn)
+    if (admissionSet[a].period != admissionSet[b].period)
     {
-        EndCriticalSection(savedmask);
-        return IRQn_INVALID;
+        return admissionSet[a].period < admissionSet[b].period;
     }
-    if(!(priority < OSINT_PRIORITY))
+    if (admissionSet[a].deadline != admissionSet[b].deadline)
     {
-        EndCriticalSection(savedmask);
-        return HWI_PRIORITY_INVALID;
+        return admissionSet[a].deadline < admissionSet[b].deadline;
     }
-    __NVIC_SetVector(IRQn, AthreadToAdd);
-    __NVIC_SetPriority(IRQn, priority);
-    __NVIC_EnableIRQ(IRQn);
-    P4->IFG &= ~BIT0;
-    EndCriticalSection(savedmask);
-    return NO_ERROR;
+    return a < b;
 }
+#endif
 
-/* - Sets dummy values for the stacks of each thread
- * - R0-R3, R12, PC, LR, PSR get auto pushed onto stack (does not push SP)
- * - sets PC to thread address
+/*
+ * Returns the sum of wcet / divisor over the admission set in millionths, each term rounded up
+ *  - divisor is each task's period for the utilisation, or its deadline for the density
  */
-void setInitialStack(void (*threadToAdd)(void), uint32_t tcbToInitialize)
+static uint64_t AdmissionLoad(bool density)
 {
-    threadStacks[tcbToInitialize][STACKSIZE-1]  = THUMBBIT;                      // set thumb bit in PSR; PSR is auto pushed to STACKSIZE-1
-    threadStacks[tcbToInitialize][STACKSIZE-2]  = (int32_t)(threadToAdd);        // set PC to new thread address
-    threadStacks[tcbToInitialize][STACKSIZE-3]  = 0x14141414;                    // R14/LR
-    threadStacks[tcbToInitialize][STACKSIZE-4]  = 0x12121212;                    // R12
-    threadStacks[tcbToInitialize][STACKSIZE-5]  = 0x03030303;                    // R3
-    threadStacks[tcbToInitialize][STACKSIZE-6]  = 0x02020202;                    // R2
-    threadStacks[tcbToInitialize][STACKSIZE-7]  = 0x01010101;                    // R1
-    threadStacks[tcbToInitialize][STACKSIZE-8]  = 0x00000000;                    // R0
-    threadStacks[tcbToInitialize][STACKSIZE-9]  = 0x0B0B0B0B;                    // R11
-    threadStacks[tcbToInitialize][STACKSIZE-10] = 0x0A0A0A0A;                    // R10
-    threadStacks[tcbToInitialize][STACKSIZE-11] = 0x09090909;                    // R9
-    threadStacks[tcbToInitialize][STACKSIZE-12] = 0x08080808;                    // R8
-    threadStacks[tcbToInitialize][STACKSIZE-13] = 0x07070707;                    // R7
-    threadStacks[tcbToInitialize][STACKSIZE-14] = 0x06060606;                    // R6
-    threadStacks[tcbToInitialize][STACKSIZE-15] = 0x05050505;                    // R5
-    threadStacks[tcbToInitialize][STACKSIZE-16] = 0x04040404;                    // R4
+    uint64_t load = 0;
+    for (uint32_t i = 0; i < admissionCount; i++)
+    {
+        uint32_t divisor = density ? admissionSet[i].deadline : admissionSet[i].period;
+        load += ((uint64_t)admissionSet[i].wcet * 1000 + divisor - 1) / divisor;       // wcet us / (divisor ms * 1000)
+    }
+    return load;
 }
 
-/* - Put current thread to sleep
+#if SCHED_POLICY != SCHED_POLICY_EDF
+/*
+ * Response-time analysis of the admission set under fixed priorities
+ *  - R = wcet + sum over every other task j of the same or higher priority of ceil(R / period j) * wcet j, iterated to a fixed point
+ *  - Tasks of the same priority count as interference both ways, as round robin can run them first
+ *  - Returns true if every task's R is within its deadline
  */
-void G8RTOS_Sleep(uint32_t duration)
+static bool ResponseTimesMet(void)
 {
-    CurrentlyRunningThread->sleepCount = duration + SystemTime;
-    CurrentlyRunningThread->asleep = true;
-    G8RTOS_Yield();
-}
-
-threadId_t G8RTOS_GetThreadID()
-{
-    return CurrentlyRunningThread->threadID;
+    for (uint32_t i = 0; i < admissionCount; i++)
+    {
+        uint64_t deadline = (uint64_t)admissionSet[i].deadline * 1000;
+        uint64_t response = admissionSet[i].wcet;
+        uint64_t previous = 0;
+        while (response != previous && response <= deadline)
+        {
+            previous = response;
+            response = admissionSet[i].wcet;
+            for (uint32_t j = 0; j < admissionCount; j++)
+            {
+                if (j != i && admissionSet[j].priority <= admissionSet[i].priority)
+                {
+                    uint64_t period = (uint64_t)admissionSet[j].period * 1000;
+                    response += (previous + period - 1) / period * admissionSet[j].wcet;
+                }
+            }
+        }
+        if (response > deadline)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+/*
+ * Schedulability test of the real-time threads alive plus a new one, for SCHED_POLICY
+ *  - Fills the admission set, the new thread is the last entry; under SCHED_POLICY_RM it also gives every entry its priority
+ *  - Returns true if the set is schedulable
+ *  - Must be called inside a critical section
+ */
+static bool AdmitRealTimeThread(const realTimeParams_t * params, uint32_t deadline)
+{
+    admissionCount = 0;
+    for (uint32_t i = 0; i < MAX_THREADS; i++)
+    {
+        tcb_t * thread = &threadControlBlocks[i];
+        if (thread->alive && thread->period)
+        {
+            admissionSet[admissionCount].thread = thread;
+            admissionSet[admissionCount].wcet = thread->wcet;
+            admissionSet[admissionCount].period = thread->period;
+            admissionSet[admissionCount].deadline = thread->relativeDeadline;
+            admissionSet[admissionCount].priority = thread->basePriority;
+            admissionCount++;
+        }
+    }
+    admissionSet[admissionCount].thread = 0;
+    admissionSet[admissionCount].wcet = params->wcet;
+    admissionSet[admissionCount].period = params->period;
+    admissionSet[admissionCount].deadline = deadline;
+    admissionSet[admissionCount].priority = params->priority;
+    admissionCount++;
+
+    if (AdmissionLoad(false) > REALTIME_UTILIZATION_LIMIT * 10000)
+    {
+        return false;                                   // more than the CPU, no policy can meet it
+    }
+
+#if SCHED_POLICY == SCHED_POLICY_EDF
+    for (uint32_t i = 0; i < admissionCount; i++)
+    {
+        if (admissionSet[i].deadline < admissionSet[i].period)
+        {
+            return AdmissionLoad(true) <= REALTIME_UTILIZATION_LIMIT * 10000;  // density test, sufficient with short deadlines
+        }
+    }
+    return true;                                        // utilisation test, exact with deadlines equal to periods
+#else
+#if SCHED_POLICY == SCHED_POLICY_RM
+    for (uint32_t i = 0; i < admissionCount; i++)
+    {
+        uint32_t rank = 0;
+        for (uint32_t j = 0; j < admissionCount; j++)
+        {
+            if (RateMonotonicBefore(j, i))
+            {
+                rank++;
+            }
+        }
+        admissionSet[i].priority = REALTIME_PRIORITY + rank;
+    }
+#endif
+    return ResponseTimesMet();
+#endif
+}
+
+#if SCHED_POLICY == SCHED_POLICY_EDF
+/*
+ * Returns true if ready thread a runs before ready thread b under SCHED_POLICY_EDF
+ *  - Earlier absolute deadline first, a thread that only runs at REALTIME_PRIORITY because it inherited it from a mutex
+ *    waiter (no period) goes before every real-time thread so it releases the mutex soon
+ */
+static bool DeadlineBefore(tcb_t * a, tcb_t * b)
+{
+    if (!a->period || !b->period)
+    {
+        return !a->period && b->period;
+    }
+    return (int32_t)(a->absoluteDeadline - b->absoluteDeadline) < 0;
+}
+#endif
+
+#if TICKLESS_IDLE
+/*
+ * Returns the number of ticks until the next sleeping thread wakes up, periodic thread or software timer is due
+ *  - Returns 0 if something is already due
+ *  - Returns UINT32_MAX if there is nothing to wait for
+ *  - Must be called inside a critical section
+ */
+static uint32_t TicksUntilNextEvent(void)
+{
+    int32_t ticks = INT32_MAX;
+
+    if (sleepingThreads)
+    {
+        ticks = (int32_t)(sleepingThreads->sleepCount - SystemTime);
+    }
+    if (NumberOfPeriodicThreads > 0)
+    {
+        int32_t periodicTicks = (int32_t)(periodicHeap[0]->executeTime - SystemTime);
+        if (periodicTicks < ticks)
+        {
+            ticks = periodicTicks;
+        }
+    }
+    int32_t timerTicks = G8RTOS_TimerTicksUntilNext();
+    if (timerTicks < ticks)
+    {
+        ticks = timerTicks;
+    }
+
+    if (ticks <= 0)
+    {
+        return 0;
+    }
+    return (ticks == INT32_MAX) ? UINT32_MAX : (uint32_t)ticks;
+}
+#endif
+
+/*
+ * Built-in idle thread, runs at IDLE_THREAD_PRIORITY whenever no other thread is ready
+ *  - With TICKLESS_IDLE, stops the tick until the next sleeping or periodic thread is due
+ *  - Ticks are only stopped when the idle thread is the only ready thread, so equal priority threads still round robin
+ */
+static void IdleThread(void)
+{
+    while(1)
+    {
+#if TICKLESS_IDLE
+        uint32_t savedmask = StartCriticalSection();
+        if (readyGroups == (0x80000000 >> (IDLE_THREAD_PRIORITY >> 5)) &&
+            readyMap[IDLE_THREAD_PRIORITY >> 5] == (0x80000000 >> (IDLE_THREAD_PRIORITY & 31)) &&
+            CurrentlyRunningThread->readyNext == CurrentlyRunningThread)
+        {
+            uint32_t idleTicks = TicksUntilNextEvent();
+            if (idleTicks > 1)
+            {
+                SystemTime += G8RTOS_PortSuppressTicks(idleTicks);
+            }
+        }
+        EndCriticalSection(savedmask);
+#endif
+    }
+}
+
+/*
+ * Chooses the next thread to run.
+ * Scheduling Algorithm:
+ * 	- Priority Round Robin: Choose the head of the ready list with the lowest # priority (highest prio)
+ * 	- If the current thread is that head, rotate the list so threads of equal priority take turns
+ * 	- Except at REALTIME_PRIORITY under SCHED_POLICY_EDF, where the list is kept in deadline order
+ * 	- Asleep and blocked threads are not in the ready lists, so they are never looked at
+ * 	- If no thread is ready, the current thread keeps running
+ */
+void G8RTOS_Scheduler()
+{
+    if (deadThread)
+    {
+        FreeThread(deadThread);                     // the thread that killed itself has been switched away from
+        deadThread = 0;
+    }
+
+#if THREAD_STATS
+    uint32_t now = G8RTOS_PortGetCycles();
+    CurrentlyRunningThread->runCycles += now - lastSwitchCycles;
+    lastSwitchCycles = now;
+#endif
+
+    if (readyGroups == 0)
+    {
+        return;
+    }
+
+    uint32_t priority = HighestReadyPriority();
+    tcb_t * nextThread = readyLists[priority];
+
+    if (nextThread == CurrentlyRunningThread && !(SCHED_POLICY == SCHED_POLICY_EDF && priority == REALTIME_PRIORITY))
+    {
+        nextThread = nextThread->readyNext;         // round robin between threads of equal priority
+        readyLists[priority] = nextThread;
+    }
+
+    tcb_t * previousThread = CurrentlyRunningThread;
+    CurrentlyRunningThread = nextThread;
+    G8RTOS_IRQ_LATENCY_SWITCH(nextThread);         // also when an interrupt woke the thread before it switched away
+    if (nextThread != previousThread)
+    {
+        G8RTOS_TRACE_EVENT(TRACE_CONTEXT_SWITCH, (uint8_t)previousThread->threadID);   // recorded as the new thread
+#if THREAD_STATS
+        nextThread->switchIns++;
+        if (previousThread->readyNext)
+        {
+            previousThread->preemptions++;          // still ready, something else got the CPU
+        }
+        else
+        {
+            previousThread->voluntarySwitches++;    // blocked, asleep or dead
+        }
+#endif
+    }
+}
+
+/*
+ * SysTick Handler
+ */
+void SysTick_Handler()
+{
+#if THREAD_STATS || JOB_STATS
+    uint32_t tickStart = G8RTOS_PortGetCycles();
+#endif
+    SystemTime++;
+#if JOB_STATS
+    tickStartCycles = tickStart;
+#endif
+    G8RTOS_TRACE_EVENT(TRACE_SYSTICK, SystemTime);
+
+    uint32_t savedmask = StartCriticalSection();    // aperiodic events may touch the ready lists
+
+    // PERIODIC THREADS - wake the periodic kernel thread when the next release is due (unless it is already awake)
+    if (PeriodicThreadDue() && periodicRelease.count <= 0)
+    {
+        G8RTOS_ReleaseSemaphore(&periodicRelease);
+    }
+
+    // SOFTWARE TIMERS - wake the timer service thread when the first running timer is due
+    G8RTOS_TimerTick();
+
+    // SLEEPING THREADS - wake up every thread at the head of the sleeping list whose wake up time has been reached
+    //                   (a thread that is also blocked waited with a timeout, which has now expired)
+    while (sleepingThreads && (int32_t)(SystemTime - sleepingThreads->sleepCount) >= 0)
+    {
+        tcb_t * wokenThread = sleepingThreads;
+        RemoveSleepingThread(wokenThread);
+        wokenThread->asleep = false;        // wake up thread
+        if (wokenThread->blocked)
+        {
+            CancelWait(wokenThread);
+            wokenThread->timedOut = true;
+        }
+        G8RTOS_AddToReadyList(wokenThread);
+    }
+
+#if THREAD_STATS
+    if ((int32_t)(SystemTime - windowEndTime) >= 0)
+    {
+        CloseStatsWindow(tickStart);
+    }
+    uint32_t tickLength = G8RTOS_PortGetCycles() - tickStart;
+    tickCycles += tickLength;
+    lastSwitchCycles += tickLength;         // the interrupted thread is not charged for the tick
+#endif
+    EndCriticalSection(savedmask);
+
+    // Trigger context switch
+    G8RTOS_Yield();
+
+}
+
+void G8RTOS_Yield()
+{
+    G8RTOS_PortYield();
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+
+/*********************************************** Public Variables *********************************************************************/
+
+/* Holds the current time for the whole System */
+uint32_t SystemTime;
+
+/* Pointer to the currently running Thread Control Block */
+tcb_t * CurrentlyRunningThread;
+
+/*********************************************** Public Variables *********************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Sets variables to an initial state (system time and number of threads)
+ * Enables board for highest speed clock and disables watchdog
+ */
+void G8RTOS_Init()
+{
+    // Set vars to initial state
+    SystemTime = 0;         // Set system time to initial value of 0
+    NumberOfThreads = 0;    // Set number of threads to initial value of 0
+    NumberOfPeriodicThreads = 0;
+    NumberOfFreeSlots = 0;
+    for (uint32_t i = MAX_THREADS; i > 0; i--)
+    {
+        freeThreadSlots[NumberOfFreeSlots++] = i - 1;   // block 0 is handed out first
+        threadControlBlocks[i - 1].alive = false;       // a second G8RTOS_Init forgets the threads of the first one
+        threadControlBlocks[i - 1].readyNext = 0;
+        threadControlBlocks[i - 1].readyPrev = 0;
+    }
+    memset(readyLists, 0, sizeof(readyLists));
+    memset(readyMap, 0, sizeof(readyMap));
+    readyGroups = 0;
+    sleepingThreads = 0;
+    deadThread = 0;
+    idleThread = 0;
+    addedThread = 0;
+    deadlineMissCallback = 0;
+    windowLength = 0;
+    tickCycles = 0;
+    InitStackArena();
+    G8RTOS_InitSemaphore(&periodicRelease, 0);
+    periodicThreadAdded = false;
+    G8RTOS_TimerReset();
+    G8RTOS_WorkReset();
+    CurrentlyRunningThread = &threadControlBlocks[0];
+    G8RTOS_PortInit();      // Vector table, board and interrupt setup for the target
+}
+
+/*
+ * Starts G8RTOS Scheduler
+ * 	- Initializes the Systick
+ * 	- Sets Context to first thread
+ * Returns: Error Code for starting scheduler. This will only return if the scheduler fails
+ */
+int G8RTOS_Launch()
+{
+    if (readyGroups == 0)
+    {
+        return NO_THREADS_SCHEDULED;
+    }
+
+    uint32_t savedmask = StartCriticalSection();
+    if (G8RTOS_AddKernelThread(IdleThread, IDLE_THREAD_PRIORITY, "idle", MIN_STACKSIZE) != NO_ERROR)
+    {
+        EndCriticalSection(savedmask);
+        return THREAD_LIMIT_REACHED;
+    }
+    idleThread = addedThread;
+    EndCriticalSection(savedmask);
+
+    CurrentlyRunningThread = readyLists[HighestReadyPriority()];    // sets CurrentlyRunningThread to highest priority thread
+
+    lastSwitchCycles = G8RTOS_PortGetCycles();
+    windowStartCycles = lastSwitchCycles;
+    tickStartCycles = lastSwitchCycles;                         // releases before the first tick are measured from here
+    windowEndTime = SystemTime + STATS_WINDOW_MS;
+
+    G8RTOS_PortInitTick();                                      // Initialize SysTick
+    G8RTOS_Start();
+    return 1;   //RETURN ERROR: should not return from Start function
+}
+
+
+/*
+ * Adds threads to G8RTOS Scheduler
+ * 	- Checks if there are still available threads to insert to scheduler
+ * 	- Initializes the thread control block for the provided thread
+ * 	- Initializes the stack for the provided thread to hold a "fake context"
+ * 	- Sets stack tcb stack pointer to top of thread stack
+ * 	- Sets up the next and previous tcb pointers in a round robin fashion
+ * Param "threadToAdd": Void-Void Function to add as preemptable main thread
+ * Returns: Error code for adding threads
+ */
+sched_ErrCode_t G8RTOS_AddThread(void (*threadToAdd)(void), uint8_t priority, char* threadname)
+{
+    return G8RTOS_AddThreadStack(threadToAdd, priority, threadname, STACKSIZE);
+}
+
+/*
+ * Adds threads to G8RTOS Scheduler with a stack of a given size
+ *  - Same as G8RTOS_AddThread, with the stack taken from the stack arena
+ *  - The thread control block comes off the free list, so adding a thread does not depend on MAX_THREADS
+ *  - The size is rounded up to an even number of words (8-byte aligned stacks) and to at least MIN_STACKSIZE
+ *  - The stack is filled with STACK_FILL_PATTERN for G8RTOS_GetStackHighWater
+ * Param "stackWords": Size of the thread's stack in 32-bit words
+ * Returns: Error code for adding threads
+ */
+sched_ErrCode_t G8RTOS_AddThreadStack(void (*threadToAdd)(void), uint8_t priority, char* threadname, uint32_t stackWords)
+{
+    if (stackWords < MIN_STACKSIZE)
+    {
+        stackWords = MIN_STACKSIZE;
+    }
+    stackWords = (stackWords + 1) & ~1;
+
+    uint32_t savedmask = StartCriticalSection(); // disable interrupts (start critical section)
+
+    if (NumberOfFreeSlots > 0)  // Checks if there are still available threads to insert to scheduler
+    {
+        int32_t * stack = AllocateStack(stackWords);
+        if (!stack)
+        {
+            EndCriticalSection(savedmask);
+            return STACK_LIMIT_REACHED;         // RETURN ERROR (no free block of the stack arena is large enough)
+        }
+        uint32_t tcbToInitialize = freeThreadSlots[--NumberOfFreeSlots];
+        for (uint32_t i = 0; i < stackWords; i++)
+        {
+            stack[i] = STACK_FILL_PATTERN;
+        }
+        threadControlBlocks[tcbToInitialize].stackBase = stack;
+        threadControlBlocks[tcbToInitialize].stackWords = stackWords;
+
+        setInitialStack(threadToAdd, tcbToInitialize);                                               // initialize fake context for new thread
+        if (NumberOfThreads == 0)
+        {
+            threadControlBlocks[tcbToInitialize].next = &threadControlBlocks[tcbToInitialize];      // Next is set to current TCB
+            threadControlBlocks[tcbToInitialize].prev = &threadControlBlocks[tcbToInitialize];      // Prev is set to current TCB
+        }
+        else
+        {
+            threadControlBlocks[tcbToInitialize].prev = CurrentlyRunningThread;
+            threadControlBlocks[tcbToInitialize].next = CurrentlyRunningThread->next;
+            threadControlBlocks[tcbToInitialize].next->prev = &threadControlBlocks[tcbToInitialize];
+            CurrentlyRunningThread->next = &threadControlBlocks[tcbToInitialize];
+        }
+
+        threadControlBlocks[tcbToInitialize].asleep = false;
+        threadControlBlocks[tcbToInitialize].blocked = 0;
+        threadControlBlocks[tcbToInitialize].waitNext = 0;
+        threadControlBlocks[tcbToInitialize].heldMutexes = 0;
+        threadControlBlocks[tcbToInitialize].notifyWait.waiters = 0;
+        threadControlBlocks[tcbToInitialize].notifyWait.type = WAIT_NOTIFICATION;
+        threadControlBlocks[tcbToInitialize].notifyValue = 0;
+        threadControlBlocks[tcbToInitialize].notifyClear = 0;
+        threadControlBlocks[tcbToInitialize].notifyPending = false;
+        threadControlBlocks[tcbToInitialize].timedOut = false;
+        threadControlBlocks[tcbToInitialize].job = 0;
+        threadControlBlocks[tcbToInitialize].period = 0;
+        memset(&threadControlBlocks[tcbToInitialize].jobStats, 0, sizeof(jobStats_t));
+        threadControlBlocks[tcbToInitialize].priority = priority;
+        threadControlBlocks[tcbToInitialize].basePriority = priority;
+        threadControlBlocks[tcbToInitialize].threadID = ((threadControlBlocks[tcbToInitialize].threadID + 0x10000) & 0xFFFF0000) | tcbToInitialize;   // next generation of this block
+        threadControlBlocks[tcbToInitialize].alive = true;
+        threadControlBlocks[tcbToInitialize].kernel = false;
+        threadControlBlocks[tcbToInitialize].runCycles = 0;
+        threadControlBlocks[tcbToInitialize].windowStart = 0;
+        threadControlBlocks[tcbToInitialize].windowCycles = 0;
+        threadControlBlocks[tcbToInitialize].switchIns = 0;
+        threadControlBlocks[tcbToInitialize].voluntarySwitches = 0;
+        threadControlBlocks[tcbToInitialize].preemptions = 0;
+        strcpy(threadControlBlocks[tcbToInitialize].threadName, threadname);
+        G8RTOS_AddToReadyList(&threadControlBlocks[tcbToInitialize]);
+        addedThread = &threadControlBlocks[tcbToInitialize];
+
+        NumberOfThreads++;
+        EndCriticalSection(savedmask);                  // enable interrupts (end critical section)
+        return NO_ERROR;
+    }
+    else
+    {
+        EndCriticalSection(savedmask);                  // enable interrupts (end critical section)
+        return THREADS_INCORRECTLY_ALIVE;       // RETURN ERROR (cannot have greater than MAX_THREADS threads)
+    }
+}
+
+/*
+ * Adds a real-time thread to G8RTOS Scheduler
+ *  - Admission test, thread creation and the rate-monotonic priority changes happen in one critical section, so the set
+ *    that was tested is the set that runs
+ *  - The thread is made ready before its job fields are set, which is safe as it cannot run before the critical section ends
+ */
+sched_ErrCode_t G8RTOS_AddRealTimeThread(void (*job)(void), const realTimeParams_t * params, char* threadName)
+{
+    uint32_t deadline = params->deadline ? params->deadline : params->period;
+    if (params->period == 0 || params->wcet == 0 || deadline > params->period || params->wcet > deadline * 1000)
+    {
+        return UNSCHEDULABLE;       // RETURN ERROR (job cannot meet its own deadline, or deadline after the next release)
+    }
+
+    uint32_t savedmask = StartCriticalSection();
+    if (!AdmitRealTimeThread(params, deadline))
+    {
+        EndCriticalSection(savedmask);
+        return UNSCHEDULABLE;
+    }
+
+#if SCHED_POLICY == SCHED_POLICY_FIXED
+    uint8_t priority = params->priority;
+#elif SCHED_POLICY == SCHED_POLICY_RM
+    uint8_t priority = admissionSet[admissionCount - 1].priority;
+#else
+    uint8_t priority = REALTIME_PRIORITY;
+#endif
+
+    sched_ErrCode_t err = G8RTOS_AddThreadStack(RealTimeThread, priority, threadName,
+                                                params->stackWords ? params->stackWords : STACKSIZE);
+    if (err != NO_ERROR)
+    {
+        EndCriticalSection(savedmask);
+        return err;
+    }
+
+    tcb_t * thread = addedThread;
+    G8RTOS_RemoveFromReadyList(thread);
+    thread->job = job;
+    thread->period = params->period;
+    thread->relativeDeadline = deadline;
+    thread->wcet = params->wcet;
+    thread->release = SystemTime;
+    thread->absoluteDeadline = SystemTime + deadline;
+    G8RTOS_AddToReadyList(thread);                  // again, now in deadline order
+
+#if SCHED_POLICY == SCHED_POLICY_RM
+    for (uint32_t i = 0; i < admissionCount - 1; i++)
+    {
+        tcb_t * other = admissionSet[i].thread;
+        if (other->basePriority != admissionSet[i].priority)
+        {
+            other->basePriority = admissionSet[i].priority;
+            G8RTOS_UpdateMutexPriority(other);      // keeps an inherited priority, and fixes up the owner of a mutex it waits for
+        }
+    }
+#endif
+    EndCriticalSection(savedmask);
+    return NO_ERROR;
+}
+
+/*
+ * Adds periodic threads to G8RTOS Scheduler
+ *  - First release is one period after the call
+ * Param "threadToAdd": Void-Void Function to run every period
+ * Param "period": Period in milliseconds
+ * Returns: 0 on success, 1 on error
+ */
+int G8RTOS_AddPeriodicThread(void (*threadToAdd)(void), uint32_t period)
+{
+    return G8RTOS_AddPeriodicThreadOffset(threadToAdd, period, period);
+}
+
+/*
+ * Adds periodic threads to G8RTOS Scheduler with a phase offset
+ *  - Checks if there are still available periodic threads
+ *  - The first periodic thread added also adds the periodic kernel thread that runs them, it is kept when they are all removed
+ *  - Initializes the periodic thread control block and inserts it into the periodic heap
+ * Param "threadToAdd": Void-Void Function to run every period
+ * Param "period": Period in milliseconds, must be non-zero
+ * Param "offset": Milliseconds from now until the first release
+ * Returns: 0 on success, 1 on error
+ */
+int G8RTOS_AddPeriodicThreadOffset(void (*threadToAdd)(void), uint32_t period, uint32_t offset)
+{
+    uint32_t savedmask = StartCriticalSection(); // disable interrupts (start critical section)
+    if (NumberOfPeriodicThreads >= MAX_PERIODIC_THREADS || period == 0)
+    {
+        EndCriticalSection(savedmask);                  // enable interrupts (end critical section)
+        return 1;       // RETURN ERROR (cannot have greater than MAX_PERIODIC_THREADS periodic threads)
+    }
+
+    if (!periodicThreadAdded)
+    {
+        if (G8RTOS_AddKernelThread(PeriodicThread, PERIODIC_THREAD_PRIORITY, "periodic", STACKSIZE) != NO_ERROR)
+        {
+            EndCriticalSection(savedmask);              // enable interrupts (end critical section)
+            return 1;       // RETURN ERROR (no thread left to run periodic threads in)
+        }
+        periodicThreadAdded = true;
+    }
+
+    // initialize periodic tcb for new periodic thread
+    ptcb_t * ptcb = &periodicThreadControlBlocks[NumberOfPeriodicThreads];
+    ptcb->handler = threadToAdd;
+    ptcb->period = period;
+    ptcb->currentTime = SystemTime;
+    ptcb->executeTime = SystemTime + offset;
+    memset(&ptcb->jobStats, 0, sizeof(jobStats_t));
+
+    periodicHeap[NumberOfPeriodicThreads] = ptcb;
+    PeriodicHeapSiftUp(NumberOfPeriodicThreads);
+    NumberOfPeriodicThreads++;
+
+    EndCriticalSection(savedmask);                  // enable interrupts (end critical section)
+    return 0;
+}
+
+/*
+ * Removes a periodic thread from G8RTOS Scheduler
+ *  - Moves the last periodic thread control block into the freed slot so the array stays packed
+ *  - Replaces the heap entry by the last heap entry and restores the heap order
+ * Param "threadToRemove": Function the periodic thread was added with
+ * Returns: 0 on success, 1 if no periodic thread runs that function
+ */
+int G8RTOS_RemovePeriodicThread(void (*threadToRemove)(void))
+{
+    uint32_t savedmask = StartCriticalSection();
+
+    uint32_t heapIndex = NumberOfPeriodicThreads;
+    for (uint32_t i = 0; i < NumberOfPeriodicThreads; i++)
+    {
+        if (periodicHeap[i]->handler == threadToRemove)
+        {
+            heapIndex = i;
+            break;
+        }
+    }
+    if (heapIndex == NumberOfPeriodicThreads)
+    {
+        EndCriticalSection(savedmask);
+        return 1;       // RETURN ERROR (no periodic thread with this handler)
+    }
+
+    ptcb_t * removed = periodicHeap[heapIndex];
+    NumberOfPeriodicThreads--;
+    if (heapIndex < NumberOfPeriodicThreads)
+    {
+        periodicHeap[heapIndex] = periodicHeap[NumberOfPeriodicThreads];
+        PeriodicHeapSiftDown(heapIndex);
+        PeriodicHeapSiftUp(heapIndex);
+    }
+
+    ptcb_t * last = &periodicThreadControlBlocks[NumberOfPeriodicThreads];
+    if (removed != last)
+    {
+        *removed = *last;
+        for (uint32_t i = 0; i < NumberOfPeriodicThreads; i++)
+        {
+            if (periodicHeap[i] == last)
+            {
+                periodicHeap[i] = removed;
+            }
+        }
+    }
+
+    EndCriticalSection(savedmask);
+    return 0;
+}
+
+int G8RTOS_GetPeriodicJobStats(void (*handler)(void), jobStats_t * stats, bool reset)
+{
+    uint32_t savedmask = StartCriticalSection();
+    for (uint32_t i = 0; i < NumberOfPeriodicThreads; i++)
+    {
+        ptcb_t * ptcb = &periodicThreadControlBlocks[i];
+        if (ptcb->handler == handler)
+        {
+            if (stats)
+            {
+                *stats = ptcb->jobStats;
+            }
+            if (reset)
+            {
+                memset(&ptcb->jobStats, 0, sizeof(jobStats_t));
+            }
+            EndCriticalSection(savedmask);
+            return 0;
+        }
+    }
+    EndCriticalSection(savedmask);
+    return 1;       // RETURN ERROR (no periodic thread with this handler)
+}
+
+sched_ErrCode_t G8RTOS_GetRealTimeJobStats(threadId_t threadId, jobStats_t * stats, bool reset)
+{
+    uint32_t savedmask = StartCriticalSection();
+    uint32_t i = ThreadIndex(threadId);
+    if (i == MAX_THREADS || !threadControlBlocks[i].period)
+    {
+        EndCriticalSection(savedmask);
+        return THREAD_DOES_NOT_EXIST;
+    }
+    if (stats)
+    {
+        *stats = threadControlBlocks[i].jobStats;
+    }
+    if (reset)
+    {
+        memset(&threadControlBlocks[i].jobStats, 0, sizeof(jobStats_t));
+    }
+    EndCriticalSection(savedmask);
+    return NO_ERROR;
+}
+
+void G8RTOS_SetDeadlineMissCallback(void (*callback)(void (*job)(void), uint32_t lateness))
+{
+    deadlineMissCallback = callback;
+}
+
+/*
+ * Adds aperiodic event to G8RTOS Scheduler
+ */
+sched_ErrCode_t G8RTOS_AddAPeriodicEvent(void (*AthreadToAdd) (void), uint8_t priority, IRQn_Type IRQn)
+{
+    uint32_t savedmask = StartCriticalSection();
+    if( IRQn < PSS_IRQn || IRQn > PORT6_IRQn)
+    {
+        EndCriticalSection(savedmask);
+        return IRQn_INVALID;
+    }
+    if(!(priority < OSINT_PRIORITY))
+    {
+        EndCriticalSection(savedmask);
+        return HWI_PRIORITY_INVALID;
+    }
+    G8RTOS_PortSetInterruptHandler(IRQn, G8RTOS_IRQ_LATENCY_HANDLER(IRQn, AthreadToAdd), priority);
+    EndCriticalSection(savedmask);
+    return NO_ERROR;
+}
+
+/* - Builds the initial "fake context" of a thread on its stack through the port
+ * - Sets the tcb stack pointer to where the context switch restores it from
+ */
+void setInitialStack(void (*threadToAdd)(void), uint32_t tcbToInitialize)
+{
+    threadControlBlocks[tcbToInitialize].sp = G8RTOS_PortInitStack(threadControlBlocks[tcbToInitialize].stackBase,
+                                                                   threadControlBlocks[tcbToInitialize].stackWords, threadToAdd);
+}
+
+/* - Put current thread to sleep
+ */
+void G8RTOS_Sleep(uint32_t duration)
+{
+    G8RTOS_TRACE_EVENT(TRACE_SLEEP, duration);
+    uint32_t savedmask = StartCriticalSection();
+    CurrentlyRunningThread->sleepCount = duration + SystemTime;
+    CurrentlyRunningThread->asleep = true;
+    G8RTOS_RemoveFromReadyList(CurrentlyRunningThread);
+    InsertSleepingThread(CurrentlyRunningThread);
+    EndCriticalSection(savedmask);
+    G8RTOS_Yield();
+}
+
+threadId_t G8RTOS_GetThreadID()
+{
+    return CurrentlyRunningThread->threadID;
+}
+
+uint32_t G8RTOS_GetNumberOfThreads()
+{
+    return NumberOfThreads;
+}
+
+uint32_t G8RTOS_GetStackHighWater(threadId_t threadId)
+{
+    uint32_t savedmask = StartCriticalSection();
+    uint32_t i = ThreadIndex(threadId);
+    if (i == MAX_THREADS)
+    {
+        EndCriticalSection(savedmask);
+        return 0;
+    }
+
+    uint32_t unused = 0;
+    while (unused < threadControlBlocks[i].stackWords && threadControlBlocks[i].stackBase[unused] == (int32_t)STACK_FILL_PATTERN)
+    {
+        unused++;           // stacks grow down, the untouched words are at the bottom
+    }
+    EndCriticalSection(savedmask);
+    return threadControlBlocks[i].stackWords - unused;
+}
+
+sched_ErrCode_t G8RTOS_GetThreadStats(threadId_t threadId, threadStats_t * stats)
+{
+    uint32_t savedmask = StartCriticalSection();
+    uint32_t i = ThreadIndex(threadId);
+    if (i == MAX_THREADS)
+    {
+        EndCriticalSection(savedmask);
+        return THREAD_DOES_NOT_EXIST;
+    }
+
+    tcb_t * thread = &threadControlBlocks[i];
+    stats->runCycles = thread->runCycles;
+#if THREAD_STATS
+    if (thread == CurrentlyRunningThread)
+    {
+        stats->runCycles += G8RTOS_PortGetCycles() - lastSwitchCycles;     // include the slice it is running in
+    }
+#endif
+    stats->switchIns = thread->switchIns;
+    stats->voluntarySwitches = thread->voluntarySwitches;
+    stats->preemptions = thread->preemptions;
+    stats->cpuPercent = WindowPercent(thread);
+    EndCriticalSection(savedmask);
+    return NO_ERROR;
+}
+
+void G8RTOS_GetSystemStats(systemStats_t * stats)
+{
+    uint32_t savedmask = StartCriticalSection();
+    stats->idleCycles = idleThread ? idleThread->runCycles : 0;
+    stats->tickCycles = tickCycles;
+    stats->cyclesPerSecond = G8RTOS_PortCyclesPerSecond();
+    stats->cpuLoadPercent = (idleThread && windowLength) ? 100 - WindowPercent(idleThread) : 0;
+    EndCriticalSection(savedmask);
 }
 
 sched_ErrCode_t G8RTOS_KillThread(threadId_t threadId)
@@ -400,18 +1427,34 @@ sched_ErrCode_t G8RTOS_KillThread(threadId_t threadId)
         EndCriticalSection(savedmask);
         return CANNOT_KILL_LAST_THREAD;
     }
-    uint32_t tcbToKill = MAX_THREADS;
-    for(int i = 0; i < MAX_THREADS; i++)
+    uint32_t tcbToKill = ThreadIndex(threadId);
+    if(tcbToKill < MAX_THREADS && threadControlBlocks[tcbToKill].kernel)
     {
-        if(threadControlBlocks[i].threadID == threadId)
-        {
-            tcbToKill = i;
-            break;
-        }
+        EndCriticalSection(savedmask);
+        return CANNOT_KILL_KERNEL_THREAD;       // the scheduler, periodic threads, timers or deferred work depend on it
     }
     if(tcbToKill < MAX_THREADS)
     {
         threadControlBlocks[tcbToKill].alive = false;
+        G8RTOS_RemoveFromReadyList(&threadControlBlocks[tcbToKill]);
+        G8RTOS_AbandonMutexes(&threadControlBlocks[tcbToKill]);
+        if (threadControlBlocks[tcbToKill].blocked)
+        {
+            CancelWait(&threadControlBlocks[tcbToKill]);
+        }
+        if (threadControlBlocks[tcbToKill].asleep)
+        {
+            RemoveSleepingThread(&threadControlBlocks[tcbToKill]);
+            threadControlBlocks[tcbToKill].asleep = false;
+        }
+        if (&threadControlBlocks[tcbToKill] == CurrentlyRunningThread)
+        {
+            deadThread = &threadControlBlocks[tcbToKill];     // still running on its stack until the next context switch
+        }
+        else
+        {
+            FreeThread(&threadControlBlocks[tcbToKill]);
+        }
         threadControlBlocks[tcbToKill].next->prev = threadControlBlocks[tcbToKill].prev;
         threadControlBlocks[tcbToKill].prev->next = threadControlBlocks[tcbToKill].next;
         NumberOfThreads--;
@@ -433,14 +1476,227 @@ sched_ErrCode_t G8RTOS_KillSelf(){
 
 sched_ErrCode_t G8RTOS_KillAllOthers()
 {
-    tcb_t *ptr = CurrentlyRunningThread;
-    for (int i = 0; i < NumberOfThreads; i++)
+    uint32_t savedmask = StartCriticalSection();
+    for (uint32_t i = 0; i < MAX_THREADS; i++)
     {
-        if(ptr->threadID != CurrentlyRunningThread->threadID)
+        tcb_t * thread = &threadControlBlocks[i];
+        if (ThreadIndex(thread->threadID) == i && thread != CurrentlyRunningThread && !thread->kernel)
         {
-            ptr = ptr->next;
-            G8RTOS_KillThread(ptr->threadID);
+            G8RTOS_KillThread(thread->threadID);
         }
     }
+    EndCriticalSection(savedmask);
+    return NO_ERROR;
 }
 /*********************************************** Public Functions *********************************************************************/
+
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Returns the thread control block of an alive thread, 0 if there is no thread with that ID
+ */
+tcb_t * G8RTOS_GetThread(threadId_t threadId)
+{
+    uint32_t i = ThreadIndex(threadId);
+    return (i == MAX_THREADS) ? 0 : &threadControlBlocks[i];
+}
+
+/*
+ * Adds a kernel thread, G8RTOS_KillThread refuses to kill it
+ *  - The thread is marked right after it was added, inside the caller's critical section, so it is never killable
+ */
+sched_ErrCode_t G8RTOS_AddKernelThread(void (*threadToAdd)(void), uint8_t priority, char* threadName, uint32_t stackWords)
+{
+    sched_ErrCode_t err = G8RTOS_AddThreadStack(threadToAdd, priority, threadName, stackWords);
+    if (err == NO_ERROR)
+    {
+        addedThread->kernel = true;
+    }
+    return err;
+}
+
+/*
+ * Puts a thread that has just blocked on an object into the sleeping list as well, so the wait ends after timeout ms
+ *  - The wait object stays in blocked, the SysTick takes the thread off it and sets timedOut if the timeout expires first
+ *  - With WAIT_FOREVER the thread is only blocked
+ */
+void G8RTOS_StartTimeout(tcb_t * thread, uint32_t timeout)
+{
+    thread->timedOut = false;
+    if (timeout != WAIT_FOREVER)
+    {
+        thread->sleepCount = SystemTime + timeout;
+        thread->asleep = true;
+        InsertSleepingThread(thread);
+    }
+}
+
+/*
+ * Ends the wait of a blocked thread because the object it waits on was signalled
+ *  - Takes it off the object's wait list and out of the sleeping list if the wait had a timeout, and makes it ready
+ *  - Inside a measured aperiodic event, the first thread woken is the one its IRQ-to-thread latency is measured to
+ */
+void G8RTOS_EndWait(tcb_t * thread)
+{
+    G8RTOS_RemoveFromWaitList(&thread->blocked->waiters, thread);
+    thread->blocked = 0;
+    if (thread->asleep)
+    {
+        RemoveSleepingThread(thread);
+        thread->asleep = false;
+    }
+    G8RTOS_AddToReadyList(thread);
+    G8RTOS_IRQ_LATENCY_WAKE(thread);
+}
+
+/*
+ * Inserts a thread at the tail of its priority's ready list
+ *  - Tail is just before the head, so the thread runs after every thread already waiting at that priority
+ *  - Under SCHED_POLICY_EDF the REALTIME_PRIORITY list is sorted instead, by absolute deadline (equal deadlines in arrival order)
+ *  - Sets the priority's bit in the ready bitmap if the list was empty
+ */
+void G8RTOS_AddToReadyList(tcb_t * thread)
+{
+    if (thread->readyNext)
+    {
+        return;     // already ready
+    }
+
+    uint8_t priority = thread->priority;
+    tcb_t * head = readyLists[priority];
+
+#if SCHED_POLICY == SCHED_POLICY_EDF
+    if (head && priority == REALTIME_PRIORITY)
+    {
+        tcb_t * next = head;
+        while (!DeadlineBefore(thread, next))
+        {
+            next = next->readyNext;
+            if (next == head)
+            {
+                break;              // latest deadline, goes to the tail
+            }
+        }
+        thread->readyNext = next;
+        thread->readyPrev = next->readyPrev;
+        next->readyPrev->readyNext = thread;
+        next->readyPrev = thread;
+        if (next == head && DeadlineBefore(thread, head))
+        {
+            readyLists[priority] = thread;
+        }
+        return;
+    }
+#endif
+
+    if (head == 0)
+    {
+        thread->readyNext = thread;
+        thread->readyPrev = thread;
+        readyLists[priority] = thread;
+        readyMap[priority >> 5] |= 0x80000000 >> (priority & 31);
+        readyGroups |= 0x80000000 >> (priority >> 5);
+    }
+    else
+    {
+        thread->readyNext = head;
+        thread->readyPrev = head->readyPrev;
+        head->readyPrev->readyNext = thread;
+        head->readyPrev = thread;
+    }
+}
+
+/*
+ * Removes a thread from its priority's ready list
+ *  - If the thread was the head, the next thread of that priority becomes the head
+ *  - Clears the priority's bit in the ready bitmap if the list becomes empty
+ */
+void G8RTOS_RemoveFromReadyList(tcb_t * thread)
+{
+    if (!thread->readyNext)
+    {
+        return;     // not ready
+    }
+
+    uint8_t priority = thread->priority;
+
+    if (thread->readyNext == thread)
+    {
+        readyLists[priority] = 0;
+        readyMap[priority >> 5] &= ~(0x80000000 >> (priority & 31));
+        if (readyMap[priority >> 5] == 0)
+        {
+            readyGroups &= ~(0x80000000 >> (priority >> 5));
+        }
+    }
+    else
+    {
+        thread->readyPrev->readyNext = thread->readyNext;
+        thread->readyNext->readyPrev = thread->readyPrev;
+        if (readyLists[priority] == thread)
+        {
+            readyLists[priority] = thread->readyNext;
+        }
+    }
+
+    thread->readyNext = 0;
+    thread->readyPrev = 0;
+}
+
+/*
+ * Inserts a thread into a wait list ordered by priority
+ *  - Walks past every thread of the same or higher priority (lower or equal #)
+ */
+void G8RTOS_AddToWaitList(tcb_t ** waitList, tcb_t * thread)
+{
+    while (*waitList && (*waitList)->priority <= thread->priority)
+    {
+        waitList = &(*waitList)->waitNext;
+    }
+    thread->waitNext = *waitList;
+    *waitList = thread;
+}
+
+/*
+ * Removes a thread from a wait list
+ */
+void G8RTOS_RemoveFromWaitList(tcb_t ** waitList, tcb_t * thread)
+{
+    while (*waitList && *waitList != thread)
+    {
+        waitList = &(*waitList)->waitNext;
+    }
+    if (*waitList)
+    {
+        *waitList = thread->waitNext;
+    }
+    thread->waitNext = 0;
+}
+
+/*
+ * Changes the priority a thread is scheduled at
+ *  - A ready thread moves to the tail of its new priority's ready list
+ *  - A blocked thread moves to its new place in the wait list of the object it is blocked on
+ */
+void G8RTOS_ChangePriority(tcb_t * thread, uint8_t priority)
+{
+    if (thread->readyNext)
+    {
+        G8RTOS_RemoveFromReadyList(thread);
+        thread->priority = priority;
+        G8RTOS_AddToReadyList(thread);
+    }
+    else
+    {
+        thread->priority = priority;
+    }
+
+    if (thread->blocked)
+    {
+        G8RTOS_RemoveFromWaitList(&thread->blocked->waiters, thread);
+        G8RTOS_AddToWaitList(&thread->blocked->waiters, thread);
+    }
+}
+
+/*********************************************** Kernel Functions *********************************************************************/
@@ -6,15 +6,44 @@
 #define G8RTOS_SCHEDULER_H_
 
 #include <stdint.h>
-#include "msp.h"
-#include "BSP.h"
+#include "G8RTOS_Port.h"
 #include "G8RTOS_Structures.h"
 
 /*********************************************** Sizes and Limits *********************************************************************/
 #define MAX_THREADS 26
 #define MAX_PERIODIC_THREADS 6
-#define STACKSIZE 512
+#ifndef STACKSIZE
+#define STACKSIZE 512               // words, stack of threads added with G8RTOS_AddThread, a port may need larger stacks
+#endif
+#ifndef MIN_STACKSIZE
+#define MIN_STACKSIZE 128           // words, smallest stack a thread gets (also the idle thread's stack)
+#endif
+#ifndef STACK_ARENA_WORDS
+#define STACK_ARENA_WORDS 8192      // words shared by all thread stacks, each stack also takes 2 header words
+#endif
+#define STACK_FILL_PATTERN 0xA5A5A5A5   // unused stack words hold this, see G8RTOS_GetStackHighWater
 #define OSINT_PRIORITY 7
+#define PRIORITY_LEVELS 256
+#define IDLE_THREAD_PRIORITY (PRIORITY_LEVELS - 1)
+#define PERIODIC_THREAD_PRIORITY 0  // priority of the kernel thread that runs periodic threads
+#ifndef TICKLESS_IDLE
+#define TICKLESS_IDLE 1             // 1: idle thread stops the 1ms tick until the next sleeping/periodic thread or software timer is due
+#endif
+#ifndef THREAD_STATS
+#define THREAD_STATS 1              // 1: context switches count the cycles each thread runs for (G8RTOS_GetThreadStats)
+#endif
+#define STATS_WINDOW_MS 1000        // length of the window CPU percentages are measured over
+#ifndef JOB_STATS
+#define JOB_STATS 1                 // 1: periodic and real-time jobs record latency, execution time and deadline misses
+#endif
+#define SCHED_POLICY_FIXED 0        // real-time threads run at the priority they declare
+#define SCHED_POLICY_RM 1           // real-time threads get priorities by period, shortest period first (rate-monotonic)
+#define SCHED_POLICY_EDF 2          // real-time threads share REALTIME_PRIORITY, the earliest absolute deadline runs first
+#ifndef SCHED_POLICY
+#define SCHED_POLICY SCHED_POLICY_FIXED
+#endif
+#define REALTIME_PRIORITY 2         // EDF: priority of every real-time thread, RM: priority of the shortest period, the others follow
+#define REALTIME_UTILIZATION_LIMIT 100  // percent of the CPU the admission test lets the real-time threads declare
 /*********************************************** Sizes and Limits *********************************************************************/
 
 
@@ -35,6 +64,7 @@ void G8RTOS_Init();
 
 /*
  * Starts G8RTOS Scheduler
+ * 	- Adds the built-in idle thread at IDLE_THREAD_PRIORITY
  * 	- Initializes Systick Timer
  * 	- Sets Context to first thread
  * Returns: Error Code for starting scheduler. This will only return if the scheduler fails
@@ -49,24 +79,95 @@ int32_t G8RTOS_Launch();
  * 	- Sets up the next and previous tcb pointers in a round robin fashion
  * Param "threadToAdd": Void-Void Function to add as preemptable main thread
  * Returns: Error code for adding threads
+ * NOTE: the thread gets a stack of STACKSIZE words, see G8RTOS_AddThreadStack for other sizes
  */
 sched_ErrCode_t G8RTOS_AddThread(void (*threadToAdd)(void), uint8_t priority, char* threadName);
 
+/*
+ * Adds threads to G8RTOS Scheduler with a stack of a given size
+ *  - Same as G8RTOS_AddThread, but the stack is stackWords words (at least MIN_STACKSIZE) instead of STACKSIZE
+ *  - Stacks are taken from a shared arena of STACK_ARENA_WORDS words and given back when the thread is killed
+ * Param "stackWords": Size of the thread's stack in 32-bit words
+ * Returns: Error code for adding threads, STACK_LIMIT_REACHED if the arena has no free block that large
+ */
+sched_ErrCode_t G8RTOS_AddThreadStack(void (*threadToAdd)(void), uint8_t priority, char* threadName, uint32_t stackWords);
+
 /*
  * Adds periodic threads to G8RTOS Scheduler
- *  - Checks if there are still available threads to insert to scheduler
- *  - Initializes the thread control block for the provided thread
- *  - Initializes the stack for the provided thread to hold a "fake context"
- *  - Sets stack tcb stack pointer to top of thread stack
- *  - Sets up the next and previous tcb pointers in a round robin fashion
- * Param "threadToAdd": Void-Void Function to add as preemptable main thread
- * Returns: Error code for adding threads
+ *  - First release is one period after the call
+ *  - Same as G8RTOS_AddPeriodicThreadOffset with offset = period
+ * Param "threadToAdd": Void-Void Function to run every period
+ * Param "period": Period in milliseconds
+ * Returns: 0 on success, 1 on error
  */
 int G8RTOS_AddPeriodicThread(void (*threadToAdd)(void), uint32_t period);
 
+/*
+ * Adds periodic threads to G8RTOS Scheduler with a phase offset
+ *  - Checks if there are still available periodic threads
+ *  - The first periodic thread added also adds the periodic kernel thread at PERIODIC_THREAD_PRIORITY
+ *  - Periodic threads run in the periodic kernel thread, not in the SysTick interrupt
+ *  - Release times do not drift: each release is exactly one period after the previous release
+ * Param "threadToAdd": Void-Void Function to run every period
+ * Param "period": Period in milliseconds, must be non-zero
+ * Param "offset": Milliseconds from now until the first release
+ * Returns: 0 on success, 1 on error
+ */
+int G8RTOS_AddPeriodicThreadOffset(void (*threadToAdd)(void), uint32_t period, uint32_t offset);
+
+
+/*
+ * Adds a real-time thread to G8RTOS Scheduler
+ *  - The thread runs job once per period, the first release is right away and releases do not drift
+ *  - A job that overruns into its next release starts the next job right after it, with that release's deadline
+ *  - Admission test over every real-time thread alive plus this one, with wcet in microseconds:
+ *      SCHED_POLICY_EDF: total utilisation (density, if a deadline is shorter than its period) within REALTIME_UTILIZATION_LIMIT
+ *      SCHED_POLICY_FIXED/RM: response-time analysis, every thread's worst case response time within its deadline
+ *  - SCHED_POLICY_RM reassigns the priorities of the real-time threads already running, from REALTIME_PRIORITY up
+ *  - The test leaves out other threads, interrupts and mutex blocking: keep other threads at lower priorities (larger #)
+ *    than the real-time band, or declare the time they take in the wcets
+ * Param "job": Void-Void Function run on every release
+ * Param "params": Worst case execution time, period, deadline (and priority, stack size) of the thread
+ * Returns: NO_ERROR, UNSCHEDULABLE if the params are invalid or the test fails, or an error of G8RTOS_AddThreadStack
+ */
+sched_ErrCode_t G8RTOS_AddRealTimeThread(void (*job)(void), const realTimeParams_t * params, char* threadName);
+
+/*
+ * Removes a periodic thread from G8RTOS Scheduler
+ *  - The periodic kernel thread stays, ready for periodic threads added later
+ * Param "threadToRemove": Function the periodic thread was added with
+ * Returns: 0 on success, 1 if no periodic thread runs that function
+ */
+int G8RTOS_RemovePeriodicThread(void (*threadToRemove)(void));
+
+/*
+ * Copies the job statistics of a periodic thread
+ * Param "handler": Function the periodic thread was added with
+ * Param "stats": Receives the statistics, may be 0 to only reset them
+ * Param "reset": true to clear the statistics after copying them
+ * Returns: 0 on success, 1 if no periodic thread runs that function
+ */
+int G8RTOS_GetPeriodicJobStats(void (*handler)(void), jobStats_t * stats, bool reset);
+
+/*
+ * Copies the job statistics of a real-time thread
+ * Param "threadId": Thread added with G8RTOS_AddRealTimeThread
+ * Param "stats": Receives the statistics, may be 0 to only reset them
+ * Param "reset": true to clear the statistics after copying them
+ * Returns: NO_ERROR, or THREAD_DOES_NOT_EXIST if there is no real-time thread with that ID
+ */
+sched_ErrCode_t G8RTOS_GetRealTimeJobStats(threadId_t threadId, jobStats_t * stats, bool reset);
+
+/*
+ * Sets the function called when a periodic or real-time job misses its deadline
+ *  - Called in the thread that ran the job, right after it, with the job's function and how late it completed in microseconds
+ * Param "callback": Function to call, 0 for none
+ */
+void G8RTOS_SetDeadlineMissCallback(void (*callback)(void (*job)(void), uint32_t lateness));
 
 /*
  * Adds aperiodic event to G8RTOS Scheduler
+ *  - With G8RTOS_IRQ_LATENCY the handler runs through a trampoline that measures the IRQ-to-thread latency (G8RTOS_GetIRQLatency)
  */
 sched_ErrCode_t G8RTOS_AddAPeriodicEvent(void (*AthreadToAdd) (void), uint8_t priority, IRQn_Type IRQn);
 
@@ -75,9 +176,8 @@ sched_ErrCode_t G8RTOS_AddAPeriodicEvent(void (*AthreadToAdd) (void), uint8_t pr
  */
 void G8RTOS_Sleep(uint32_t duration);
 
-/* - Sets dummy values for the stacks of each thread
- * - R0-R3, R12, PC, LR, PSR get auto pushed onto stack (does not push SP)
- * - sets PC to thread address
+/* - Builds the initial "fake context" of a thread on its stack (see G8RTOS_PortInitStack)
+ * - Sets the tcb stack pointer to where the context switch restores it from
  */
 void setInitialStack(void (*threadToAdd)(void), uint32_t tcbToInitialize);
 
@@ -86,8 +186,41 @@ void setInitialStack(void (*threadToAdd)(void), uint32_t tcbToInitialize);
  */
 void G8RTOS_Yield();
 
+/*
+ * Returns the threadID of the thread that calls function
+ *  - Low 16 bits: thread control block index, high 16 bits: generation of that block (changes every time it is reused)
+ */
+threadId_t G8RTOS_GetThreadID();
+
+/*
+ * Returns the number of alive threads, including the kernel's own threads
+ */
+uint32_t G8RTOS_GetNumberOfThreads();
+
+/*
+ * Returns the most stack a thread has used so far, in 32-bit words
+ *  - Stacks are filled with STACK_FILL_PATTERN when a thread is added, the high water mark is the highest word that changed
+ *  - Returns 0 if there is no thread with that ID
+ */
+uint32_t G8RTOS_GetStackHighWater(threadId_t threadId);
+
+/*
+ * Copies the runtime statistics of a thread
+ *  - Counts start at 0 when the thread is added, and stay 0 without THREAD_STATS
+ * Param "stats": Filled in with the thread's statistics
+ * Returns: NO_ERROR, or THREAD_DOES_NOT_EXIST if there is no thread with that ID
+ */
+sched_ErrCode_t G8RTOS_GetThreadStats(threadId_t threadId, threadStats_t * stats);
+
+/*
+ * Copies the idle and SysTick cycle counts and the CPU load of the last window
+ */
+void G8RTOS_GetSystemStats(systemStats_t * stats);
+
 /*
  * Kills a specific thread, given it's threadID
+ *  - The ID is checked in constant time, IDs of threads that were already killed are rejected with THREAD_DOES_NOT_EXIST
+ *  - The kernel's own threads (idle, periodic, timer service, worker) are rejected with CANNOT_KILL_KERNEL_THREAD
  */
 sched_ErrCode_t G8RTOS_KillThread(threadId_t threadId);
 
@@ -98,8 +231,88 @@ sched_ErrCode_t G8RTOS_KillSelf();
 
 /*
  * Kills all other threads BESIDES the one calling this function
+ *  - The kernel's own threads keep running
+ * Returns: NO_ERROR
  */
 sched_ErrCode_t G8RTOS_KillAllOthers();
 /*********************************************** Public Functions *********************************************************************/
 
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Chooses the next thread to run, called by the port's context switch with interrupts disabled
+ */
+void G8RTOS_Scheduler();
+
+/*
+ * 1ms tick, called by the port's tick interrupt
+ */
+void SysTick_Handler();
+
+/*
+ * Returns the thread control block of an alive thread, 0 if there is no thread with that ID
+ *  - Must be called inside a critical section, the thread could be killed otherwise
+ */
+tcb_t * G8RTOS_GetThread(threadId_t threadId);
+
+/*
+ * Adds one of the kernel's own threads (idle, periodic, timer service, worker)
+ *  - Same as G8RTOS_AddThreadStack, but the thread is marked as a kernel thread so G8RTOS_KillThread refuses to kill it
+ *  - Must be called inside a critical section
+ * Returns: Error code of G8RTOS_AddThreadStack
+ */
+sched_ErrCode_t G8RTOS_AddKernelThread(void (*threadToAdd)(void), uint8_t priority, char* threadName, uint32_t stackWords);
+
+/*
+ * Starts the timeout of a thread that has just blocked on a wait object (timed wait)
+ *  - The thread is in the object's wait list and, unless timeout is WAIT_FOREVER, in the sleeping list as well
+ *  - If the timeout expires first, the SysTick takes it off the wait object, sets timedOut and makes it ready
+ *  - Must be called inside a critical section
+ */
+void G8RTOS_StartTimeout(tcb_t * thread, uint32_t timeout);
+
+/*
+ * Ends the wait of a blocked thread: takes it off its wait object and the sleeping list and makes it ready
+ *  - Used by whatever signals the object, instead of G8RTOS_AddToReadyList, once a waiter may have a timeout
+ *  - Must be called inside a critical section
+ */
+void G8RTOS_EndWait(tcb_t * thread);
+
+/*
+ * Inserts a thread at the tail of its priority's ready list
+ *  - Does nothing if the thread is already ready
+ *  - Must be called inside a critical section
+ */
+void G8RTOS_AddToReadyList(tcb_t * thread);
+
+/*
+ * Removes a thread from its priority's ready list (thread is going to sleep, blocking or dying)
+ *  - Does nothing if the thread is not ready
+ *  - Must be called inside a critical section
+ */
+void G8RTOS_RemoveFromReadyList(tcb_t * thread);
+
+/*
+ * Inserts a thread into a wait list ordered by priority
+ *  - Behind every thread of the same or higher priority, so equal priorities are served first come first served
+ *  - Must be called inside a critical section
+ */
+void G8RTOS_AddToWaitList(tcb_t ** waitList, tcb_t * thread);
+
+/*
+ * Removes a thread from a wait list, does nothing if it is not in it
+ *  - Must be called inside a critical section
+ */
+void G8RTOS_RemoveFromWaitList(tcb_t ** waitList, tcb_t * thread);
+
+/*
+ * Changes the priority a thread is scheduled at, used for mutex priority inheritance
+ *  - Keeps the ready lists and the wait list of the object the thread is blocked on in order
+ *  - Must be called inside a critical section
+ */
+void G8RTOS_ChangePriority(tcb_t * thread, uint8_t priority);
+
+/*********************************************** Kernel Functions *********************************************************************/
+
 #endif /* G8RTOS_SCHEDULER_H_ */
@@ -28,7 +28,9 @@ G8RTOS_Start:
 	LDR R1, [R0]			; R1 has value within running ptr -- a ptr to the thread's stack
 	LDR SP, [R1]			; load stack pointer from tcb
 
+	ADD SP, SP, #4			; discard alignment padding
 	POP {R4 - R11}			; load fake context into registers
+	ADD SP, SP, #4			; discard EXC_RETURN, the first thread is started without an exception return
 	POP {R0 - R3}
 	POP {R12}
 	ADD SP, SP, #4			; discard LR from initial stack
@@ -40,31 +42,41 @@ G8RTOS_Start:
 
 ; PendSV_Handler
 ; - Performs a context switch in G8RTOS
-; 	- Saves remaining registers into thread stack
+;	- EXC_RETURN bit 4 is clear if the thread has used the FPU (the hardware reserved an extended frame for S0-S15, FPSCR)
+;	- Only then saves S16-S31, which also makes the hardware store the lazily reserved S0-S15, FPSCR
+; 	- Saves remaining registers and the thread's EXC_RETURN into thread stack
 ;	- Saves current stack pointer to tcb
 ;	- Calls G8RTOS_Scheduler to get new tcb
 ;	- Set stack pointer to new stack pointer from new tcb
-;	- Pops registers from thread stack
+;	- Pops registers and EXC_RETURN from thread stack, then S16-S31 if the new thread has used the FPU
+;	- Integer-only threads never touch the FPU registers
 PendSV_Handler:
 	
 	.asmfunc
 
 	CPSID I				; disable interrupts (enter critical section)
 
-	PUSH {R4 - R11}		; saves remaining registers into thread stack
+	TST LR, #0x10		; EXC_RETURN bit 4 clear: thread has FPU context
+	IT EQ
+	VSTMDBEQ SP!, {S16 - S31}
+
+	PUSH {R3 - R11, LR}	; saves remaining registers and EXC_RETURN into thread stack (R3 only keeps the stack 8-byte aligned)
 
 	LDR R0, RunningPtr  ; R0 has address of RunningPtr
 	LDR R1, [R0]		; R1 has value within running ptr -- a ptr to the thread's stack
 	STR SP, [R1]		; saves current stack pointer to tcb
 
-	PUSH {R0, LR}		; preserve values of registers
 	BL G8RTOS_Scheduler	; calls G8RTOS_Scheduler to get new tcb
-	POP	 {R0, LR}		; restore values of registers
 
-	LDR R1, [R0]		; set stack pointer to new stack pointer from new TCB
+	LDR R0, RunningPtr	; set stack pointer to new stack pointer from new TCB
+	LDR R1, [R0]
 	LDR SP, [R1]
 
-	POP {R4 - R11}
+	POP {R3 - R11, LR}	; LR is the new thread's EXC_RETURN (R3 is restored from the hardware frame)
+
+	TST LR, #0x10
+	IT EQ
+	VLDMIAEQ SP!, {S16 - S31}
 
 	CPSIE I 			; re-enable interrupts (leave critical section)
 
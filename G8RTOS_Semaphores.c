@@ -5,11 +5,11 @@
 /*********************************************** Dependencies and Externs *************************************************************/
 
 #include <stdint.h>
-#include "msp.h"
-#include <G8RTOS/G8RTOS_Semaphores.h>
-#include <G8RTOS/G8RTOS_CriticalSection.h>
-#include <G8RTOS/G8RTOS_Scheduler.h>
-#include <G8RTOS/G8RTOS_Structures.h>
+#include "G8RTOS_Semaphores.h"
+#include "G8RTOS_Port.h"
+#include "G8RTOS_Scheduler.h"
+#include "G8RTOS_Structures.h"
+#include "G8RTOS_Trace.h"
 
 
 /*********************************************** Dependencies and Externs *************************************************************/
@@ -26,38 +26,75 @@
 void G8RTOS_InitSemaphore(semaphore_t *s, int32_t value)
 {
     uint32_t savedmask = StartCriticalSection();             // disable interrupts (end critical section)
-    *s=value;
+    s->count = value;
+    s->wait.waiters = 0;
+    s->wait.type = WAIT_SEMAPHORE;
     EndCriticalSection(savedmask);                  // enable interrupts
 }
 
 /*
  * Waits for a semaphore to be available (value greater than 0)
+ * 	- Same as G8RTOS_AcquireSemaphoreTimeout without a timeout
+ */
+void G8RTOS_AcquireSemaphore(semaphore_t *s)
+{
+    G8RTOS_AcquireSemaphoreTimeout(s, WAIT_FOREVER);
+}
+
+/*
+ * Takes a semaphore only if it is available right away
+ * Returns: 0 if the semaphore was taken, 1 if it was not available
+ */
+int G8RTOS_TryAcquireSemaphore(semaphore_t *s)
+{
+    return G8RTOS_AcquireSemaphoreTimeout(s, 0);
+}
+
+/*
+ * Waits at most timeout ms for a semaphore to be available (value greater than 0)
  * 	- Decrements semaphore when available
- * 	- Spinlocks to wait for semaphore
+ * 	- Otherwise blocks the thread in the semaphore's wait list (ordered by priority), and in the sleeping list until the timeout
+ * 	- A timeout takes the thread off the wait list and gives the count back (see G8RTOS_StartTimeout)
  * Param "s": Pointer to semaphore to wait on
+ * Param "timeout": Milliseconds to wait at most, 0 to not wait, WAIT_FOREVER to wait without timeout
+ * Returns: 0 if the semaphore was taken, 1 if the timeout expired first
  * THIS IS A CRITICAL SECTION
  */
-void G8RTOS_AcquireSemaphore(semaphore_t *s)
+int G8RTOS_AcquireSemaphoreTimeout(semaphore_t *s, uint32_t timeout)
 {
     uint32_t savedmask = StartCriticalSection();  // disable interrupts
 
-    (*s)--;
+    if (s->count <= 0 && timeout == 0)
+    {
+        EndCriticalSection(savedmask);
+        return 1;
+    }
 
-    if ((*s) < 0)
+    s->count--;
+
+    if (s->count < 0)
     {
-        CurrentlyRunningThread->blocked = s;
+        G8RTOS_TRACE_EVENT(TRACE_SEMAPHORE_BLOCK, (uintptr_t)s);
+        CurrentlyRunningThread->blocked = &s->wait;
+        G8RTOS_RemoveFromReadyList(CurrentlyRunningThread);  // blocked threads are skipped by the scheduler
+        G8RTOS_AddToWaitList(&s->wait.waiters, CurrentlyRunningThread);
+        G8RTOS_StartTimeout(CurrentlyRunningThread, timeout);
 
         EndCriticalSection(savedmask);            // enable interrupts
 
         G8RTOS_Yield();                         // triggers context switch to let other thread go instead
+        return CurrentlyRunningThread->timedOut ? 1 : 0;
     }
 
+    G8RTOS_TRACE_EVENT(TRACE_SEMAPHORE_ACQUIRE, (uintptr_t)s);
     EndCriticalSection(savedmask);
+    return 0;
 }
 
 /*
  * Signals the completion of the usage of a semaphore
  * 	- Increments the semaphore value by 1
+ * 	- Wakes the thread at the head of the wait list (highest priority, longest waiting)
  * Param "s": Pointer to semaphore to be signalled
  * THIS IS A CRITICAL SECTION
  */
@@ -65,17 +102,12 @@ void G8RTOS_ReleaseSemaphore(semaphore_t *s)
 {
 	uint32_t savedmask = StartCriticalSection();
 
-	(*s)++;     // set the semaphore - resource
+	s->count++;     // set the semaphore - resource
+	G8RTOS_TRACE_EVENT(TRACE_SEMAPHORE_RELEASE, (uintptr_t)s);
 
-	if ((*s) <= 0)
+	if (s->count <= 0 && s->wait.waiters)
 	{
-	    tcb_t *pt = CurrentlyRunningThread->next;
-	    while(pt->blocked != s)
-	    {
-	        pt = pt->next;
-	    }
-
-	    pt->blocked = 0;
+	    G8RTOS_EndWait(s->wait.waiters);   // also ends the waiter's timeout
 	}
 
 	EndCriticalSection(savedmask);
@@ -5,12 +5,22 @@
 #ifndef G8RTOS_SEMAPHORES_H_
 #define G8RTOS_SEMAPHORES_H_
 
+#include <stdint.h>
+#include "G8RTOS_WaitObject.h"
+
 /*********************************************** Datatype Definitions *****************************************************************/
 
 /*
  * Semaphore typedef
+ *      - wait: threads blocked on the semaphore, highest priority first and first come first served within a priority
+ *      - count: semaphore value, when negative its magnitude is the number of waiting threads
+ *      - Only use the functions below on it, the G8RTOS_InitSemaphore/Acquire/Release API is the same as for the old int32_t semaphore
  */
-typedef int32_t semaphore_t;
+typedef struct semaphore_t
+{
+    waitObject_t wait;
+    int32_t count;
+} semaphore_t;
 
 /*********************************************** Datatype Definitions *****************************************************************/
 
@@ -27,14 +37,32 @@ void G8RTOS_InitSemaphore(semaphore_t *s, int32_t value);
 /*
  * Waits for a semaphore to be available (value greater than 0)
  * 	- Decrements semaphore when available
- * 	- Spinlocks to wait for semaphore
+ * 	- Blocks the thread until it is
  * Param "s": Pointer to semaphore to wait on
  */
 void G8RTOS_AcquireSemaphore(semaphore_t *s);
 
+/*
+ * Takes a semaphore only if it is available right away, callable from ISRs
+ * Param "s": Pointer to semaphore
+ * Returns: 0 if the semaphore was taken, 1 if it was not available
+ */
+int G8RTOS_TryAcquireSemaphore(semaphore_t *s);
+
+/*
+ * Waits at most timeout ms for a semaphore to be available (value greater than 0)
+ * 	- Decrements semaphore when available
+ * 	- Blocks the thread until it is or until the timeout expires
+ * Param "s": Pointer to semaphore to wait on
+ * Param "timeout": Milliseconds to wait at most, 0 to not wait, WAIT_FOREVER to wait without timeout
+ * Returns: 0 if the semaphore was taken, 1 if the timeout expired first
+ */
+int G8RTOS_AcquireSemaphoreTimeout(semaphore_t *s, uint32_t timeout);
+
 /*
  * Signals the completion of the usage of a semaphore
  * 	- Increments the semaphore value by 1
+ * 	- Wakes the highest priority waiting thread, if any
  * Param "s": Pointer to semaphore to be signalled
  */
 void G8RTOS_ReleaseSemaphore(semaphore_t *s);
@@ -10,10 +10,33 @@
 #include <G8RTOS.h>
 #include "stdbool.h"
 #include "G8RTOS_Semaphores.h"
+#include "G8RTOS_Mutex.h"
+#include "G8RTOS_EventGroup.h"
 #define MAX_NAME_LENGTH     10
+#define JOB_HISTOGRAM_BUCKETS 16    // log2 buckets of the job latency/execution histograms, the last one takes everything above
 
 /*********************************************** Data Structure Definitions ***********************************************************/
 
+/*
+ * Job statistics of a periodic or real-time thread, see G8RTOS_GetPeriodicJobStats / G8RTOS_GetRealTimeJobStats (JOB_STATS)
+ *      - jobs: jobs that ran to completion
+ *      - misses: jobs that completed at or after their deadline (the next release for periodic threads)
+ *      - overruns: jobs that ran longer than their budget (the declared wcet, the period for periodic threads)
+ *      - maxLatency / maxExecution: largest release-to-start latency and execution time seen, in microseconds
+ *      - latency / execution: histograms in microseconds, bucket 0 counts values below 1us, bucket k values in [2^(k-1), 2^k)
+ *      - Execution time is the CPU time the running thread was charged for the job (THREAD_STATS), so preemptions are not in it
+ */
+typedef struct jobStats_t
+{
+    uint32_t jobs;
+    uint32_t misses;
+    uint32_t overruns;
+    uint32_t maxLatency;
+    uint32_t maxExecution;
+    uint32_t latency[JOB_HISTOGRAM_BUCKETS];
+    uint32_t execution[JOB_HISTOGRAM_BUCKETS];
+} jobStats_t;
+
 /*
  *  Thread Control Block:
  *      - Every thread has a Thread Control Block
@@ -23,33 +46,112 @@
 typedef struct tcb_t
 {
     int32_t * sp;           // stack pointer for this thread
+    int32_t * stackBase;    // lowest address of the thread's stack in the stack arena
+    uint32_t stackWords;    // size of the thread's stack in words
     struct tcb_t * next;    // pointer to next tcb
     struct tcb_t * prev;    // pointer to previous tcb
-    semaphore_t * blocked;  // blocking semaphore
-    uint32_t sleepCount;    // how long thread has been asleep
-    bool asleep;            // thread waits for certain amnt of time before it enters active state
-    uint8_t priority;       // thread priority (lower number = higher priority, to match ARM Cortex-M convention)
+    struct tcb_t * readyNext;   // next tcb in this thread's priority ready list (0 when not ready)
+    struct tcb_t * readyPrev;   // previous tcb in this thread's priority ready list (0 when not ready)
+    struct tcb_t * sleepNext;   // next tcb in the sleeping list (wakes at the same time or later)
+    struct tcb_t * sleepPrev;   // previous tcb in the sleeping list
+    waitObject_t * blocked; // semaphore, mutex or event group the thread is blocked on
+    struct tcb_t * waitNext;    // next tcb waiting on the same object
+    uint32_t eventBits;     // bits waited for in an event group, the group's bits (or the notification value) that ended the wait once woken
+    uint8_t eventOptions;   // EVENT_WAIT_ALL / EVENT_CLEAR_ON_EXIT of the event group wait
+    mutex_t * heldMutexes;  // mutexes owned by the thread, linked through nextHeld
+    waitObject_t notifyWait;    // blocked points to it while the thread waits for a notification
+    uint32_t notifyValue;   // notification value, see G8RTOS_Notify
+    uint32_t notifyClear;   // bits of notifyValue cleared when the notification waited for arrives
+    bool notifyPending;     // a notification arrived that G8RTOS_NotifyWait has not taken yet
+    uint32_t sleepCount;    // system time at which the thread wakes up (or its wait times out)
+    bool asleep;            // thread waits for certain amnt of time before it enters active state, or waits with a timeout
+    bool timedOut;          // the last timed wait ended because its timeout expired
+    void (*job)(void);      // real-time threads: function run once per release, 0 for other threads
+    uint32_t period;        // real-time threads: ms between releases, 0 for other threads
+    uint32_t relativeDeadline;  // real-time threads: ms from a release until the job must be done
+    uint32_t wcet;          // real-time threads: declared worst case execution time of a job in microseconds
+    uint32_t release;       // real-time threads: system time of the current job's release
+    uint32_t absoluteDeadline;  // real-time threads: release + relativeDeadline, the ready list order under SCHED_POLICY_EDF
+    jobStats_t jobStats;    // real-time threads: latency, execution time and deadline misses of the jobs (JOB_STATS)
+    uint8_t priority;       // thread priority (lower number = higher priority, to match ARM Cortex-M convention), raised while a mutex it owns is wanted by a higher priority thread
+    uint8_t basePriority;   // priority the thread was added with
     bool alive;
+    bool kernel;            // idle, periodic, timer service or worker thread, G8RTOS_KillThread refuses to kill it
     uint32_t threadID;
     char threadName[MAX_NAME_LENGTH];
+    uint64_t runCycles;     // cycles the thread has run for in total (THREAD_STATS)
+    uint64_t windowStart;   // runCycles when the current statistics window started
+    uint32_t windowCycles;  // cycles the thread ran for in the last complete statistics window
+    uint32_t switchIns;     // times the thread was switched to
+    uint32_t voluntarySwitches; // times it was switched away from after blocking, sleeping or dying
+    uint32_t preemptions;   // times it was switched away from while still ready
 
 } tcb_t;
 
 /*
  * Periodic Thread Control Block
+ *      - Periodic threads are kept in a min-heap ordered by executeTime and run by the periodic kernel thread
  */
 typedef struct ptcb_t
 {
     void (*handler)(void);
     uint32_t period;
-    uint32_t executeTime;
-    uint32_t currentTime;
-    struct pEvent_t * next;
-    struct pEvent_t * prev;
+    uint32_t executeTime;   // absolute system time of the next release
+    uint32_t currentTime;   // system time the periodic thread was added at
+    jobStats_t jobStats;    // latency, execution time and deadline misses of the jobs (JOB_STATS)
 } ptcb_t;
 
 typedef uint32_t threadId_t;
 
+/*
+ * Real-time thread declaration, see G8RTOS_AddRealTimeThread
+ *      - wcet: worst case execution time of one job in microseconds, measured or bounded by the application
+ *      - period: milliseconds between releases
+ *      - deadline: milliseconds from a release until the job must be done, at most period (0 for period)
+ *      - priority: used by SCHED_POLICY_FIXED only, rate-monotonic and EDF choose the priority themselves
+ *      - stackWords: stack size in words, 0 for STACKSIZE
+ */
+typedef struct realTimeParams_t
+{
+    uint32_t wcet;
+    uint32_t period;
+    uint32_t deadline;
+    uint8_t priority;
+    uint32_t stackWords;
+} realTimeParams_t;
+
+/*
+ * Thread runtime statistics, see G8RTOS_GetThreadStats
+ *      - runCycles: G8RTOS_PortGetCycles counts the thread ran for, interrupt handlers are not charged to it
+ *      - switchIns: times the thread was switched to
+ *      - voluntarySwitches: times it gave up the CPU by blocking, sleeping or dying
+ *      - preemptions: times it was switched away from while still ready (tick round robin or a higher priority thread)
+ *      - cpuPercent: share of the CPU it had in the last complete STATS_WINDOW_MS window
+ */
+typedef struct threadStats_t
+{
+    uint64_t runCycles;
+    uint32_t switchIns;
+    uint32_t voluntarySwitches;
+    uint32_t preemptions;
+    uint8_t cpuPercent;
+} threadStats_t;
+
+/*
+ * System runtime statistics, see G8RTOS_GetSystemStats
+ *      - idleCycles: cycles spent in the idle thread
+ *      - tickCycles: cycles spent in the SysTick handler
+ *      - cyclesPerSecond: rate of the cycle counts
+ *      - cpuLoadPercent: share of the last complete STATS_WINDOW_MS window not spent in the idle thread
+ */
+typedef struct systemStats_t
+{
+    uint64_t idleCycles;
+    uint64_t tickCycles;
+    uint32_t cyclesPerSecond;
+    uint8_t cpuLoadPercent;
+} systemStats_t;
+
 typedef enum
 {
         NO_ERROR                    = 0,
@@ -59,7 +161,10 @@ typedef enum
         THREAD_DOES_NOT_EXIST       = -4,
         CANNOT_KILL_LAST_THREAD     = -5,
         IRQn_INVALID                = -6,
-        HWI_PRIORITY_INVALID        = -7
+        HWI_PRIORITY_INVALID        = -7,
+        STACK_LIMIT_REACHED         = -8,
+        UNSCHEDULABLE               = -9,
+        CANNOT_KILL_KERNEL_THREAD   = -10
 } sched_ErrCode_t;
 
 /*********************************************** Data Structure Definitions ***********************************************************/
@@ -67,7 +172,7 @@ typedef enum
 
 /*********************************************** Public Variables *********************************************************************/
 
-tcb_t * CurrentlyRunningThread;
+extern tcb_t * CurrentlyRunningThread;
 
 /*********************************************** Public Variables *********************************************************************/
 
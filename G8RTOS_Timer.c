@@ -0,0 +1,250 @@
+/*
+ * G8RTOS_Timer.c
+ */
+
+/***************************************************** Includes ***********************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "G8RTOS_Timer.h"
+#include "G8RTOS_Port.h"
+#include "G8RTOS_Scheduler.h"
+#include "G8RTOS_Semaphores.h"
+
+/***************************************************** Includes ***********************************************************************/
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*
+ * Running timers
+ *  - Doubly linked list sorted by expiry, earliest first, timers expiring at the same time keep the order they were started in
+ */
+static softTimer_t * activeTimers;
+
+/*
+ * Released by the SysTick when the first timer is due, the timer service thread waits on it
+ */
+static semaphore_t timerRelease;
+
+/*
+ * Set once the timer service thread has been added
+ */
+static bool timerThreadAdded;
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Inserts a timer into the list of running timers in expiry order
+ *  - Times are compared as a signed difference so SystemTime wrapping around is handled
+ *  - Must be called inside a critical section
+ */
+static void InsertTimer(softTimer_t * timer)
+{
+    softTimer_t * prev = 0;
+    softTimer_t * next = activeTimers;
+    while (next && (int32_t)(next->expiry - timer->expiry) <= 0)
+    {
+        prev = next;
+        next = next->next;
+    }
+
+    timer->prev = prev;
+    timer->next = next;
+    if (prev)
+    {
+        prev->next = timer;
+    }
+    else
+    {
+        activeTimers = timer;
+    }
+    if (next)
+    {
+        next->prev = timer;
+    }
+    timer->active = true;
+}
+
+/*
+ * Removes a timer from the list of running timers
+ *  - Must be called inside a critical section
+ */
+static void RemoveTimer(softTimer_t * timer)
+{
+    if (timer->prev)
+    {
+        timer->prev->next = timer->next;
+    }
+    else
+    {
+        activeTimers = timer->next;
+    }
+    if (timer->next)
+    {
+        timer->next->prev = timer->prev;
+    }
+    timer->next = 0;
+    timer->prev = 0;
+    timer->active = false;
+}
+
+/*
+ * Returns true if the first running timer has expired
+ *  - Must be called inside a critical section
+ */
+static bool TimerDue(void)
+{
+    return activeTimers && (int32_t)(SystemTime - activeTimers->expiry) >= 0;
+}
+
+/*
+ * Timer service thread, runs at TIMER_THREAD_PRIORITY
+ *  - Waits until the SysTick signals that the first timer is due
+ *  - Takes every due timer off the list in expiry order and runs its callback outside of the critical section
+ *  - An auto-reload timer is put back before its callback runs, so the callback can stop or reset it
+ */
+static void TimerThread(void)
+{
+    while(1)
+    {
+        G8RTOS_AcquireSemaphore(&timerRelease);
+
+        uint32_t savedmask = StartCriticalSection();
+        while (TimerDue())
+        {
+            softTimer_t * timer = activeTimers;
+            RemoveTimer(timer);
+            if (timer->autoReload)
+            {
+                timer->expiry += timer->period;     // next expiry is one period after this one, not after now
+                InsertTimer(timer);
+            }
+            void (*callback)(void *) = timer->callback;
+            void * arg = timer->arg;
+            EndCriticalSection(savedmask);
+
+            callback(arg);
+
+            savedmask = StartCriticalSection();
+        }
+        EndCriticalSection(savedmask);
+    }
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+int G8RTOS_InitTimer(softTimer_t * timer, void (*callback)(void * arg), void * arg, uint32_t period, bool autoReload)
+{
+    if (period == 0)
+    {
+        return 1;
+    }
+
+    uint32_t savedmask = StartCriticalSection();
+    if (!timerThreadAdded)
+    {
+        G8RTOS_InitSemaphore(&timerRelease, 0);
+        if (G8RTOS_AddKernelThread(TimerThread, TIMER_THREAD_PRIORITY, "timers", TIMER_THREAD_STACKSIZE) != NO_ERROR)
+        {
+            EndCriticalSection(savedmask);
+            return 1;       // RETURN ERROR (no thread left to run the timer callbacks in)
+        }
+        timerThreadAdded = true;
+    }
+
+    timer->next = 0;
+    timer->prev = 0;
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->period = period;
+    timer->expiry = 0;
+    timer->autoReload = autoReload;
+    timer->active = false;
+    EndCriticalSection(savedmask);
+    return 0;
+}
+
+void G8RTOS_StartTimer(softTimer_t * timer)
+{
+    uint32_t savedmask = StartCriticalSection();
+    if (!timer->active)
+    {
+        timer->expiry = SystemTime + timer->period;
+        InsertTimer(timer);
+    }
+    EndCriticalSection(savedmask);
+}
+
+void G8RTOS_StopTimer(softTimer_t * timer)
+{
+    uint32_t savedmask = StartCriticalSection();
+    if (timer->active)
+    {
+        RemoveTimer(timer);
+    }
+    EndCriticalSection(savedmask);
+}
+
+void G8RTOS_ResetTimer(softTimer_t * timer)
+{
+    uint32_t savedmask = StartCriticalSection();
+    if (timer->active)
+    {
+        RemoveTimer(timer);
+    }
+    timer->expiry = SystemTime + timer->period;
+    InsertTimer(timer);
+    EndCriticalSection(savedmask);
+}
+
+int G8RTOS_ChangeTimerPeriod(softTimer_t * timer, uint32_t period)
+{
+    if (period == 0)
+    {
+        return 1;
+    }
+    uint32_t savedmask = StartCriticalSection();
+    timer->period = period;
+    G8RTOS_ResetTimer(timer);
+    EndCriticalSection(savedmask);
+    return 0;
+}
+
+bool G8RTOS_TimerActive(softTimer_t * timer)
+{
+    return timer->active;
+}
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+void G8RTOS_TimerReset(void)
+{
+    activeTimers = 0;
+    timerThreadAdded = false;
+}
+
+void G8RTOS_TimerTick(void)
+{
+    if (TimerDue() && timerRelease.count <= 0)
+    {
+        G8RTOS_ReleaseSemaphore(&timerRelease);
+    }
+}
+
+int32_t G8RTOS_TimerTicksUntilNext(void)
+{
+    if (!activeTimers)
+    {
+        return INT32_MAX;
+    }
+    int32_t ticks = (int32_t)(activeTimers->expiry - SystemTime);
+    return ticks < 0 ? 0 : ticks;
+}
+
+/*********************************************** Kernel Functions *********************************************************************/
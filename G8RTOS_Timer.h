@@ -0,0 +1,118 @@
+/*
+ * G8RTOS_Timer.h
+ *
+ * Software timers: one-shot and auto-reload callbacks run by a single timer service thread
+ */
+
+#ifndef G8RTOS_TIMER_H_
+#define G8RTOS_TIMER_H_
+
+/***************************************************** Includes ***********************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/***************************************************** Includes ***********************************************************************/
+
+/*************************************************** Defines Used *********************************************************************/
+
+#ifndef TIMER_THREAD_PRIORITY
+#define TIMER_THREAD_PRIORITY 1         // priority of the timer service thread that runs the callbacks
+#endif
+#ifndef TIMER_THREAD_STACKSIZE
+#define TIMER_THREAD_STACKSIZE STACKSIZE    // words, stack of the timer service thread (all callbacks run on it)
+#endif
+
+/*************************************************** Defines Used *********************************************************************/
+
+/************************************************* Structures Used ********************************************************************/
+
+/*
+ * Software timer typedef
+ *      - Storage is given by the application, there is no limit on the number of timers
+ *      - Running timers are in a list sorted by expiry, the SysTick only looks at the head
+ *      - next/prev: neighbours in the list of running timers
+ *      - expiry: system time the timer fires at
+ *      - period: milliseconds from start to firing, and between firings of an auto-reload timer
+ */
+typedef struct softTimer_t
+{
+    struct softTimer_t * next;
+    struct softTimer_t * prev;
+    void (*callback)(void * arg);
+    void * arg;
+    uint32_t period;
+    uint32_t expiry;
+    bool autoReload;
+    bool active;
+} softTimer_t;
+
+/************************************************* Structures Used ********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes a stopped software timer
+ *  - The first timer initialized also adds the timer service thread at TIMER_THREAD_PRIORITY
+ * Param "timer": Pointer to timer
+ * Param "callback": Called with arg in the timer service thread every time the timer fires, must not block for long
+ * Param "period": Milliseconds until the timer fires once started, must be non-zero
+ * Param "autoReload": false: fires once per start, true: fires every period until stopped (without drift)
+ * Returns: 0 on success, 1 on error (period is 0 or the timer service thread could not be added)
+ */
+int G8RTOS_InitTimer(softTimer_t * timer, void (*callback)(void * arg), void * arg, uint32_t period, bool autoReload);
+
+/*
+ * Starts a timer, it fires one period from now, does nothing if it is already running
+ * Callable from ISRs and from timer callbacks
+ */
+void G8RTOS_StartTimer(softTimer_t * timer);
+
+/*
+ * Stops a timer, it does not fire again until started
+ * Callable from ISRs and from timer callbacks
+ */
+void G8RTOS_StopTimer(softTimer_t * timer);
+
+/*
+ * Restarts a timer, it fires one period from now whether it was running or not
+ * Callable from ISRs and from timer callbacks
+ */
+void G8RTOS_ResetTimer(softTimer_t * timer);
+
+/*
+ * Changes the period of a timer and restarts it
+ * Param "period": New period in milliseconds, must be non-zero
+ * Returns: 0 on success, 1 if period is 0
+ */
+int G8RTOS_ChangeTimerPeriod(softTimer_t * timer, uint32_t period);
+
+/*
+ * Returns true while a timer is running
+ */
+bool G8RTOS_TimerActive(softTimer_t * timer);
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Forgets every running timer and the timer service thread, called by G8RTOS_Init
+ *  - The next G8RTOS_InitTimer adds the timer service thread again
+ */
+void G8RTOS_TimerReset(void);
+
+/*
+ * Wakes the timer service thread if the first timer is due, called by the SysTick inside a critical section
+ */
+void G8RTOS_TimerTick(void);
+
+/*
+ * Returns the ticks until the first timer is due (0 if it already is), INT32_MAX if no timer runs
+ *  - Used by tickless idle, must be called inside a critical section
+ */
+int32_t G8RTOS_TimerTicksUntilNext(void);
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+#endif /* G8RTOS_TIMER_H_ */
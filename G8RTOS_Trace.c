@@ -0,0 +1,108 @@
+/*
+ * G8RTOS_Trace.c
+ */
+
+/***************************************************** Includes ***********************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "G8RTOS_Trace.h"
+#include "G8RTOS_Port.h"
+#include "G8RTOS_Scheduler.h"
+#include "G8RTOS_Structures.h"
+
+/***************************************************** Includes ***********************************************************************/
+
+#if G8RTOS_TRACE
+
+/*************************************************** Defines Used *********************************************************************/
+
+#if (TRACE_BUFFER_RECORDS & (TRACE_BUFFER_RECORDS - 1)) != 0
+#error "TRACE_BUFFER_RECORDS must be a power of 2"
+#endif
+
+#define TRACE_INDEX_MASK (TRACE_BUFFER_RECORDS - 1)
+
+/*************************************************** Defines Used *********************************************************************/
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*
+ * Trace ring buffer
+ *      - traceWriteIndex counts every record ever claimed, the slot is its low bits
+ *      - Once it passed TRACE_BUFFER_RECORDS, the slot it points to holds the oldest record
+ */
+static traceRecord_t traceBuffer[TRACE_BUFFER_RECORDS];
+static volatile uint32_t traceWriteIndex;
+static volatile bool traceEnabled = true;
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+void G8RTOS_TraceRecord(uint8_t event, uint32_t arg)
+{
+    if (!traceEnabled)
+    {
+        return;
+    }
+
+    traceRecord_t * record = &traceBuffer[G8RTOS_PortAtomicFetchAdd(&traceWriteIndex, 1) & TRACE_INDEX_MASK];
+    record->timestamp = G8RTOS_PortGetCycles();
+    record->event = event;
+    record->thread = CurrentlyRunningThread ? (uint8_t)CurrentlyRunningThread->threadID : 0xFF;
+    record->arg = (uint16_t)arg;
+}
+
+void G8RTOS_TraceEnable(bool enable)
+{
+    traceEnabled = enable;
+}
+
+void G8RTOS_TraceDump(void (*write)(const void * data, uint32_t length))
+{
+    bool wasEnabled = traceEnabled;
+    traceEnabled = false;
+    G8RTOS_PORT_MEMORY_BARRIER();                   // records claimed before this point are finished before they are read
+
+    traceThread_t threads[MAX_THREADS];
+    uint32_t threadCount = 0;
+
+    uint32_t savedmask = StartCriticalSection();    // the thread ring must not change while it is walked
+    tcb_t * pt = CurrentlyRunningThread;
+    if (pt)
+    {
+        do
+        {
+            threads[threadCount].threadID = pt->threadID;
+            memset(threads[threadCount].name, 0, TRACE_NAME_LENGTH);
+            memcpy(threads[threadCount].name, pt->threadName, MAX_NAME_LENGTH);
+            threadCount++;
+            pt = pt->next;
+        } while (pt != CurrentlyRunningThread && threadCount < MAX_THREADS);
+    }
+    EndCriticalSection(savedmask);
+
+    uint32_t written = traceWriteIndex;
+    uint32_t recordCount = written < TRACE_BUFFER_RECORDS ? written : TRACE_BUFFER_RECORDS;
+
+    traceHeader_t header = { TRACE_MAGIC, G8RTOS_PortCyclesPerSecond(), threadCount, recordCount };
+    write(&header, sizeof(header));
+    write(threads, threadCount * sizeof(traceThread_t));
+
+    uint32_t oldest = (written - recordCount) & TRACE_INDEX_MASK;
+    uint32_t firstPart = TRACE_BUFFER_RECORDS - oldest;
+    if (firstPart > recordCount)
+    {
+        firstPart = recordCount;
+    }
+    write(&traceBuffer[oldest], firstPart * sizeof(traceRecord_t));
+    write(&traceBuffer[0], (recordCount - firstPart) * sizeof(traceRecord_t));
+
+    traceEnabled = wasEnabled;
+}
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_TRACE */
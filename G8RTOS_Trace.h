@@ -0,0 +1,115 @@
+/*
+ * G8RTOS_Trace.h
+ *
+ * Kernel event tracing into a RAM ring buffer
+ *      - Enable with G8RTOS_TRACE 1, with 0 the hooks compile to nothing and there is no buffer
+ *      - Every event is an 8 byte record: cycle counter timestamp, event, running thread, argument
+ *      - G8RTOS_TraceDump writes the buffer in the format below, tools/trace2json.c turns it into Chrome trace/Perfetto JSON
+ */
+
+#ifndef G8RTOS_TRACE_H_
+#define G8RTOS_TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+#ifndef G8RTOS_TRACE
+#define G8RTOS_TRACE 0              // 1: kernel events are recorded into the trace buffer
+#endif
+#ifndef TRACE_BUFFER_RECORDS
+#define TRACE_BUFFER_RECORDS 512    // records in the ring buffer (8 bytes each), must be a power of 2
+#endif
+#define TRACE_MAGIC 0x52543847      // "G8TR" at the start of a dump
+#define TRACE_NAME_LENGTH 12
+
+/*********************************************** Sizes and Limits *********************************************************************/
+
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+/*
+ * Traced events and the meaning of their argument
+ */
+typedef enum
+{
+    TRACE_CONTEXT_SWITCH        = 1,    // thread: thread switched to, arg: thread switched from
+    TRACE_SYSTICK               = 2,    // arg: SystemTime
+    TRACE_SLEEP                 = 3,    // arg: duration in ms
+    TRACE_SEMAPHORE_ACQUIRE     = 4,    // arg: semaphore address, got it without blocking
+    TRACE_SEMAPHORE_BLOCK       = 5,    // arg: semaphore address, blocks on it
+    TRACE_SEMAPHORE_RELEASE     = 6,    // arg: semaphore address
+    TRACE_FIFO_READ             = 7,    // arg: FIFO index
+    TRACE_FIFO_WRITE            = 8     // arg: FIFO index
+} traceEvent_t;
+
+/*
+ * Trace record, as stored in the buffer and in a dump
+ *      - timestamp: G8RTOS_PortGetCycles when the event happened
+ *      - thread: thread control block index (low byte of the thread ID) of the running thread
+ *      - arg: low 16 bits of the event's argument
+ */
+typedef struct traceRecord_t
+{
+    uint32_t timestamp;
+    uint8_t event;
+    uint8_t thread;
+    uint16_t arg;
+} traceRecord_t;
+
+/*
+ * Dump layout: traceHeader_t, threadCount traceThread_t, recordCount traceRecord_t (oldest first), all little endian
+ */
+typedef struct traceHeader_t
+{
+    uint32_t magic;
+    uint32_t cyclesPerSecond;
+    uint32_t threadCount;
+    uint32_t recordCount;
+} traceHeader_t;
+
+typedef struct traceThread_t
+{
+    uint32_t threadID;
+    char name[TRACE_NAME_LENGTH];
+} traceThread_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+
+/*********************************************** Public Functions *********************************************************************/
+
+#if G8RTOS_TRACE
+
+/*
+ * Records an event, callable from threads and ISRs
+ *  - The slot is claimed with an atomic increment, so no critical section is needed
+ *  - When the buffer is full the oldest record is overwritten
+ */
+void G8RTOS_TraceRecord(uint8_t event, uint32_t arg);
+
+/*
+ * Starts or stops recording (recording is on from reset)
+ */
+void G8RTOS_TraceEnable(bool enable);
+
+/*
+ * Writes the trace buffer out in the dump layout
+ *  - Recording is paused while the dump is written
+ *  - Threads listed are the ones alive at the time of the dump
+ * Param "write": Called with consecutive pieces of the dump
+ */
+void G8RTOS_TraceDump(void (*write)(const void * data, uint32_t length));
+
+#define G8RTOS_TRACE_EVENT(event, arg) G8RTOS_TraceRecord((event), (uint32_t)(arg))
+
+#else
+
+#define G8RTOS_TRACE_EVENT(event, arg) ((void)0)
+
+#endif /* G8RTOS_TRACE */
+
+/*********************************************** Public Functions *********************************************************************/
+
+#endif /* G8RTOS_TRACE_H_ */
@@ -0,0 +1,46 @@
+/*
+ * G8RTOS_WaitObject.h
+ */
+
+#ifndef G8RTOS_WAITOBJECT_H_
+#define G8RTOS_WAITOBJECT_H_
+
+#include <stdint.h>
+
+/*********************************************** Defines Used *************************************************************************/
+
+#define WAIT_FOREVER 0xFFFFFFFF     // timeout of a wait that only ends when it is satisfied
+
+/*********************************************** Defines Used *************************************************************************/
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+struct tcb_t;
+
+/*
+ * Kinds of objects a thread can block on
+ */
+typedef enum
+{
+    WAIT_SEMAPHORE      = 0,
+    WAIT_MUTEX          = 1,
+    WAIT_EVENT_GROUP    = 2,
+    WAIT_NOTIFICATION   = 3
+} waitType_t;
+
+/*
+ * Wait Object typedef
+ *      - First member of every object a thread can block on (semaphore_t, mutex_t, eventGroup_t), tcb_t.blocked points to it
+ *      - Every thread control block has one of its own for notifications (tcb_t.notifyWait)
+ *      - waiters: threads blocked on the object, highest priority first and first come first served within a priority
+ *      - type: tells the kernel which object the wait object is part of
+ */
+typedef struct waitObject_t
+{
+    struct tcb_t * waiters;
+    uint8_t type;
+} waitObject_t;
+
+/*********************************************** Datatype Definitions *****************************************************************/
+
+#endif /* G8RTOS_WAITOBJECT_H_ */
@@ -0,0 +1,135 @@
+/*
+ * G8RTOS_WorkQueue.c
+ */
+
+/***************************************************** Includes ***********************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "G8RTOS_WorkQueue.h"
+#include "G8RTOS_Port.h"
+#include "G8RTOS_Scheduler.h"
+#include "G8RTOS_Semaphores.h"
+
+/***************************************************** Includes ***********************************************************************/
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*
+ * Posted work items
+ *  - Lock-free stack, newest first: G8RTOS_DeferWork pushes with a compare-and-swap, the worker takes the whole stack at once
+ *  - Only the worker ever removes items, and it removes all of them, so a pushed item can never be removed and pushed again
+ *    under a producer's feet (no ABA problem)
+ */
+static deferredWork_t * volatile postedWork;
+
+/*
+ * Released when an item is pushed onto an empty stack, the worker thread waits on it
+ */
+static semaphore_t workPosted;
+
+/*
+ * Set once the worker thread has been added
+ */
+static bool workThreadAdded;
+
+/*********************************************** Data Structures Used *****************************************************************/
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*
+ * Worker thread, runs at WORK_THREAD_PRIORITY
+ *  - Takes every posted item, reverses them into posting order and runs them
+ *  - An item's pending flag is cleared right before it runs, so posting it from then on queues it again
+ */
+static void WorkThread(void)
+{
+    while(1)
+    {
+        G8RTOS_AcquireSemaphore(&workPosted);
+
+        deferredWork_t * work;
+        do
+        {
+            work = postedWork;
+        } while (!G8RTOS_PortAtomicCompareExchangePointer((void * volatile *)&postedWork, work, 0));
+
+        deferredWork_t * ordered = 0;
+        while (work)
+        {
+            deferredWork_t * next = work->next;
+            work->next = ordered;
+            ordered = work;
+            work = next;
+        }
+
+        while (ordered)
+        {
+            deferredWork_t * next = ordered->next;  // read before the item can be posted again
+            G8RTOS_PORT_MEMORY_BARRIER();
+            ordered->pending = 0;
+            ordered->function(ordered->arg);
+            ordered = next;
+        }
+    }
+}
+
+/*********************************************** Private Functions ********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+int G8RTOS_InitWork(deferredWork_t * work, void (*function)(void * arg), void * arg)
+{
+    uint32_t savedmask = StartCriticalSection();
+    if (!workThreadAdded)
+    {
+        G8RTOS_InitSemaphore(&workPosted, 0);
+        if (G8RTOS_AddKernelThread(WorkThread, WORK_THREAD_PRIORITY, "worker", WORK_THREAD_STACKSIZE) != NO_ERROR)
+        {
+            EndCriticalSection(savedmask);
+            return 1;       // RETURN ERROR (no thread left to run deferred work in)
+        }
+        workThreadAdded = true;
+    }
+
+    work->next = 0;
+    work->function = function;
+    work->arg = arg;
+    work->pending = 0;
+    EndCriticalSection(savedmask);
+    return 0;
+}
+
+int G8RTOS_DeferWork(deferredWork_t * work)
+{
+    if (!G8RTOS_PortAtomicCompareExchange(&work->pending, 0, 1))
+    {
+        return 1;           // already pending, the worker has not started it yet
+    }
+
+    deferredWork_t * head;
+    do
+    {
+        head = postedWork;
+        work->next = head;
+    } while (!G8RTOS_PortAtomicCompareExchangePointer((void * volatile *)&postedWork, head, work));
+
+    if (head == 0)
+    {
+        G8RTOS_ReleaseSemaphore(&workPosted);   // the worker drains the whole stack, so only the first item wakes it
+        G8RTOS_Yield();                         // from an ISR, the switch happens once it returns
+    }
+    return 0;
+}
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+void G8RTOS_WorkReset(void)
+{
+    postedWork = 0;
+    workThreadAdded = false;
+}
+
+/*********************************************** Kernel Functions *********************************************************************/
@@ -0,0 +1,80 @@
+/*
+ * G8RTOS_WorkQueue.h
+ *
+ * Deferred work: interrupt handlers post work items that a kernel worker thread runs later
+ *      - Posting is lock-free (one compare-and-swap), so an ISR only acknowledges its source and posts
+ *      - A work item that is posted again before it ran is only run once (coalescing)
+ */
+
+#ifndef G8RTOS_WORKQUEUE_H_
+#define G8RTOS_WORKQUEUE_H_
+
+/***************************************************** Includes ***********************************************************************/
+
+#include <stdint.h>
+
+/***************************************************** Includes ***********************************************************************/
+
+/*************************************************** Defines Used *********************************************************************/
+
+#ifndef WORK_THREAD_PRIORITY
+#define WORK_THREAD_PRIORITY 1          // priority of the worker thread, deferred work runs above every thread with a larger number
+#endif
+#ifndef WORK_THREAD_STACKSIZE
+#define WORK_THREAD_STACKSIZE STACKSIZE // words, stack of the worker thread (all work items run on it)
+#endif
+
+/*************************************************** Defines Used *********************************************************************/
+
+/************************************************* Structures Used ********************************************************************/
+
+/*
+ * Work item typedef
+ *      - Storage is given by the application, usually one static work item per interrupt source
+ *      - next: next item posted before this one, while pending
+ *      - pending: 1 from G8RTOS_DeferWork until the worker starts running the item
+ */
+typedef struct deferredWork_t
+{
+    struct deferredWork_t * next;
+    void (*function)(void * arg);
+    void * arg;
+    volatile uint32_t pending;
+} deferredWork_t;
+
+/************************************************* Structures Used ********************************************************************/
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*
+ * Initializes a work item
+ *  - The first work item initialized also adds the worker thread at WORK_THREAD_PRIORITY
+ * Param "work": Pointer to work item
+ * Param "function": Called with arg in the worker thread every time the item runs
+ * Returns: 0 on success, 1 if the worker thread could not be added
+ */
+int G8RTOS_InitWork(deferredWork_t * work, void (*function)(void * arg), void * arg);
+
+/*
+ * Posts a work item to the worker thread, callable from ISRs of any priority and from threads
+ *  - Items run in the order they were posted
+ *  - If the item is already pending, it is not posted again: it still runs (once) after this call
+ *  - An item posted while it runs is run again afterwards
+ * Param "work": Initialized work item
+ * Returns: 0 if the item was posted, 1 if it was already pending
+ */
+int G8RTOS_DeferWork(deferredWork_t * work);
+
+/*********************************************** Public Functions *********************************************************************/
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+/*
+ * Forgets every posted work item and the worker thread, called by G8RTOS_Init
+ *  - The next G8RTOS_InitWork adds the worker thread again
+ */
+void G8RTOS_WorkReset(void);
+
+/*********************************************** Kernel Functions *********************************************************************/
+
+#endif /* G8RTOS_WORKQUEUE_H_ */
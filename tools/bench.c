@@ -0,0 +1,39 @@
+/*
+ * bench.c
+ *
+ * Host benchmark runner on the POSIX port, prints the G8RTOS_RunBenchmarks CSV to stdout
+ *      - Build: make (from the repository root), the program is build/g8bench
+ *      - Use: build/g8bench > results.csv
+ *      - Host "cycles" are nanoseconds of the monotonic clock, so the numbers include whatever else the host is running
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "G8RTOS.h"
+#include "G8RTOS_Benchmark.h"
+
+#define BENCH_PRIORITY 10       // below the kernel threads, the inversion helpers run at the three priorities below it
+
+static void PrintLine(const char * line)
+{
+    puts(line);
+}
+
+static void BenchThread(void)
+{
+    G8RTOS_RunBenchmarks(PrintLine);
+    fflush(stdout);
+    exit(0);
+}
+
+int main(void)
+{
+    G8RTOS_Init();
+    if (G8RTOS_AddThread(BenchThread, BENCH_PRIORITY, "bench") != NO_ERROR)
+    {
+        fprintf(stderr, "g8bench: could not add the benchmark thread\n");
+        return 1;
+    }
+    G8RTOS_Launch();
+    return 1;
+}
@@ -0,0 +1,508 @@
+/*
+ * check.c
+ *
+ * Host regression checks on the POSIX port
+ *      - Build and run: make check (from the repository root)
+ *      - Each check runs inside a thread after G8RTOS_Launch and prints a line when it fails
+ *      - Checks of a scheduling policy or option only build with it, e.g. make clean check CPPFLAGS+=-DSCHED_POLICY=1
+ *      - The C++ layer (G8RTOS.hpp) is checked by tools/check_cpp.cpp, run from here
+ *      - Exit status: 0 if every check passed, 1 otherwise
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "G8RTOS.h"
+#include "G8RTOS_Structures.h"
+
+#define CHECK_PRIORITY 10       // below the kernel threads
+#define CHECK_PERIOD 2          // milliseconds between two runs of the periodic thread
+#define CHECK_ROUNDS 5          // remove/add rounds of the periodic thread check
+#define TIMER_PERIOD 5          // milliseconds, period of the timers in the timer check
+#define TIMER_PERIODS 10        // periods the timer check sleeps for
+#define TIMER_STOP_AFTER 3      // firings after which the self-stopping timer stops itself
+#define WORK_REPOSTS 2          // times the re-posting work item posts itself again from inside its function
+#define CHECK_TIMEOUT 5         // milliseconds, timeout of the waits that are expected to time out
+#define CHECK_FIFO 0            // FIFO the timeout checks use
+#define CHECK_POOL_BLOCKS 4     // blocks of the pool in the pool check
+#define WAITER_PRIORITY 9       // above the check thread, a waiter runs as soon as its wait ends
+#define PARKED_PRIORITY 20      // below the check thread, parked threads never get to run while it works
+
+#define CHECK(condition) Check((condition), #condition, __LINE__)
+
+static uint32_t failures;
+
+uint32_t CheckCpp(void);                // tools/check_cpp.cpp, returns its failed checks
+
+static volatile uint32_t periodicRuns;
+
+static void Check(bool passed, const char * condition, int line)
+{
+    if (!passed)
+    {
+        printf("check.c:%d: failed: %s\n", line, condition);
+        failures++;
+    }
+}
+
+static void CountingPeriodicThread(void)
+{
+    periodicRuns++;
+}
+
+/*
+ * Removing the last periodic thread and adding one again must reuse the periodic kernel thread instead of adding another
+ */
+static void CheckPeriodicReAdd(void)
+{
+    uint32_t threads = G8RTOS_GetNumberOfThreads();
+    CHECK(G8RTOS_AddPeriodicThread(CountingPeriodicThread, CHECK_PERIOD) == 0);
+    uint32_t withPeriodic = G8RTOS_GetNumberOfThreads();
+    CHECK(withPeriodic == threads + 1);
+
+    for (uint32_t round = 0; round < CHECK_ROUNDS; round++)
+    {
+        CHECK(G8RTOS_RemovePeriodicThread(CountingPeriodicThread) == 0);
+        CHECK(G8RTOS_RemovePeriodicThread(CountingPeriodicThread) == 1);
+        CHECK(G8RTOS_AddPeriodicThread(CountingPeriodicThread, CHECK_PERIOD) == 0);
+        CHECK(G8RTOS_GetNumberOfThreads() == withPeriodic);
+
+        uint32_t runs = periodicRuns;
+        G8RTOS_Sleep(4 * CHECK_PERIOD);
+        CHECK(periodicRuns > runs);             // the kept kernel thread still runs the re-added thread
+    }
+
+    CHECK(G8RTOS_RemovePeriodicThread(CountingPeriodicThread) == 0);
+    CHECK(G8RTOS_GetNumberOfThreads() == withPeriodic);
+}
+
+/*
+ * The kernel's own threads cannot be killed, every other thread in the ring of threads can
+ *  - Runs after CheckPeriodicReAdd, so the idle and the periodic kernel thread are both there
+ */
+static void CheckKernelThreadsKill(void)
+{
+    uint32_t kernelThreads = 0;
+    tcb_t * thread = CurrentlyRunningThread;
+    do
+    {
+        if (thread->kernel)
+        {
+            kernelThreads++;
+            CHECK(G8RTOS_KillThread(thread->threadID) == CANNOT_KILL_KERNEL_THREAD);
+            CHECK(thread->alive);
+        }
+        thread = thread->next;
+    } while (thread != CurrentlyRunningThread);
+    CHECK(kernelThreads == 2);
+}
+
+static void ParkedThread(void)
+{
+    while (1)
+    {
+        G8RTOS_Sleep(1000);
+    }
+}
+
+/*
+ * A killed thread's ID stays invalid once its thread control block is reused by a new thread
+ */
+static void CheckKilledThreadID(void)
+{
+    uint32_t threads = G8RTOS_GetNumberOfThreads();
+    CHECK(G8RTOS_AddThread(ParkedThread, PARKED_PRIORITY, "old") == NO_ERROR);
+    threadId_t oldId = CurrentlyRunningThread->next->threadID;      // added right after the running thread
+    CHECK(G8RTOS_KillThread(oldId) == NO_ERROR);
+
+    CHECK(G8RTOS_AddThread(ParkedThread, PARKED_PRIORITY, "new") == NO_ERROR);
+    threadId_t newId = CurrentlyRunningThread->next->threadID;
+    CHECK((newId & 0xFFFF) == (oldId & 0xFFFF));                    // same slot, next generation
+    CHECK(newId != oldId);
+
+    threadStats_t stats;
+    CHECK(G8RTOS_KillThread(oldId) == THREAD_DOES_NOT_EXIST);
+    CHECK(G8RTOS_GetThreadStats(oldId, &stats) == THREAD_DOES_NOT_EXIST);
+    CHECK(G8RTOS_GetThreadStats(newId, &stats) == NO_ERROR);
+    CHECK(G8RTOS_GetNumberOfThreads() == threads + 1);
+
+    CHECK(G8RTOS_AddThread(ParkedThread, PARKED_PRIORITY, "other") == NO_ERROR);
+    CHECK(G8RTOS_KillAllOthers() == NO_ERROR);
+    CHECK(G8RTOS_GetThreadStats(newId, &stats) == THREAD_DOES_NOT_EXIST);
+    CHECK(G8RTOS_GetNumberOfThreads() == threads);                  // the check thread and the kernel threads are left
+}
+
+static softTimer_t staleTimer;
+static uint32_t staleRuns;
+
+static softTimer_t oneShotTimer;
+static softTimer_t reloadTimer;
+static softTimer_t stoppingTimer;
+
+static void CountingTimer(void * arg)
+{
+    (*(uint32_t *)arg)++;
+}
+
+static void StoppingTimer(void * arg)
+{
+    if (++(*(uint32_t *)arg) == TIMER_STOP_AFTER)
+    {
+        G8RTOS_StopTimer(&stoppingTimer);
+    }
+}
+
+/*
+ * A one-shot timer fires once per start, an auto-reload timer every period, a callback can stop its own timer,
+ * and a changed period applies from the change on
+ */
+static void CheckTimers(void)
+{
+    uint32_t oneShots = 0, reloads = 0, stops = 0;
+    CHECK(G8RTOS_InitTimer(&oneShotTimer, CountingTimer, &oneShots, TIMER_PERIOD, false) == 0);
+    CHECK(G8RTOS_InitTimer(&reloadTimer, CountingTimer, &reloads, TIMER_PERIOD, true) == 0);
+    CHECK(G8RTOS_InitTimer(&stoppingTimer, StoppingTimer, &stops, TIMER_PERIOD, true) == 0);
+    G8RTOS_StartTimer(&oneShotTimer);
+    G8RTOS_StartTimer(&reloadTimer);
+    G8RTOS_StartTimer(&stoppingTimer);
+    G8RTOS_Sleep(TIMER_PERIODS * TIMER_PERIOD + TIMER_PERIOD / 2);
+
+    CHECK(oneShots == 1);
+    CHECK(!G8RTOS_TimerActive(&oneShotTimer));
+    CHECK(reloads == TIMER_PERIODS);
+    CHECK(G8RTOS_TimerActive(&reloadTimer));
+    CHECK(stops == TIMER_STOP_AFTER);
+    CHECK(!G8RTOS_TimerActive(&stoppingTimer));
+
+    reloads = 0;
+    CHECK(G8RTOS_ChangeTimerPeriod(&reloadTimer, 2 * TIMER_PERIOD) == 0);
+    CHECK(G8RTOS_ChangeTimerPeriod(&reloadTimer, 0) == 1);
+    G8RTOS_Sleep(TIMER_PERIODS * TIMER_PERIOD + TIMER_PERIOD / 2);
+    CHECK(reloads == TIMER_PERIODS / 2);
+    G8RTOS_StopTimer(&reloadTimer);
+}
+
+static deferredWork_t staleWork;
+
+static deferredWork_t countingWork;
+static deferredWork_t repostingWork;
+
+static void CountingWork(void * arg)
+{
+    (*(uint32_t *)arg)++;
+}
+
+static void RepostingWork(void * arg)
+{
+    if ((*(uint32_t *)arg)++ < WORK_REPOSTS)
+    {
+        CHECK(G8RTOS_DeferWork(&repostingWork) == 0);   // no longer pending once it runs
+    }
+}
+
+/*
+ * Posting a pending work item again does not queue it twice, posting it from inside its function runs it again
+ */
+static void CheckDeferredWork(void)
+{
+    uint32_t counted = 0, reposted = 0;
+    CHECK(G8RTOS_InitWork(&countingWork, CountingWork, &counted) == 0);
+    CHECK(G8RTOS_InitWork(&repostingWork, RepostingWork, &reposted) == 0);
+
+    uint32_t savedmask = StartCriticalSection();   // the worker cannot run before both posts
+    CHECK(G8RTOS_DeferWork(&countingWork) == 0);
+    CHECK(G8RTOS_DeferWork(&countingWork) == 1);
+    EndCriticalSection(savedmask);
+    G8RTOS_Sleep(1);
+    CHECK(counted == 1);
+
+    CHECK(G8RTOS_DeferWork(&repostingWork) == 0);
+    G8RTOS_Sleep(1);
+    CHECK(reposted == WORK_REPOSTS + 1);
+}
+
+static semaphore_t timeoutSemaphore;
+
+static void ReleasingThread(void)
+{
+    G8RTOS_Sleep(1);
+    G8RTOS_ReleaseSemaphore(&timeoutSemaphore);
+    G8RTOS_KillSelf();
+}
+
+/*
+ * A timed wait returns 1 once its timeout expired, and leaves nothing behind: the waiter is off the wait list and out of the
+ * sleeping list, and the semaphore count it took is given back
+ */
+static void CheckSemaphoreTimeout(void)
+{
+    G8RTOS_InitSemaphore(&timeoutSemaphore, 0);
+    uint32_t start = SystemTime;
+    CHECK(G8RTOS_AcquireSemaphoreTimeout(&timeoutSemaphore, CHECK_TIMEOUT) == 1);
+    CHECK(SystemTime - start >= CHECK_TIMEOUT);
+    CHECK(timeoutSemaphore.wait.waiters == 0);
+    CHECK(timeoutSemaphore.count == 0);
+    CHECK(!CurrentlyRunningThread->blocked && !CurrentlyRunningThread->asleep);
+    CHECK(G8RTOS_AcquireSemaphoreTimeout(&timeoutSemaphore, 0) == 1);
+
+    CHECK(G8RTOS_AddThread(ReleasingThread, CHECK_PRIORITY + 1, "release") == NO_ERROR);
+    start = SystemTime;
+    CHECK(G8RTOS_AcquireSemaphoreTimeout(&timeoutSemaphore, 10 * CHECK_TIMEOUT) == 0);
+    CHECK(SystemTime - start < 10 * CHECK_TIMEOUT);
+    CHECK(!CurrentlyRunningThread->asleep);                         // the timeout was cancelled
+    CHECK(timeoutSemaphore.count == 0);
+}
+
+/*
+ * Reading an empty FIFO and writing a full one time out, and a FIFO works normally after a timed-out wait
+ *  - Locked and SPSC mode, FIFO indices past MAX_FIFOS are rejected by every entry point
+ */
+static void CheckFIFOTimeout(void)
+{
+    for (uint32_t spsc = 0; spsc < 2; spsc++)
+    {
+        int32_t data = 0;
+        CHECK(spsc ? G8RTOS_InitFIFOSPSC(CHECK_FIFO, 1) : G8RTOS_InitFIFO(CHECK_FIFO));
+        CHECK(G8RTOS_ReadFIFOTimeout(CHECK_FIFO, &data, CHECK_TIMEOUT) == 1);
+        CHECK(G8RTOS_WriteFIFO(CHECK_FIFO, 1) == 0);
+        CHECK(G8RTOS_ReadFIFOTimeout(CHECK_FIFO, &data, 0) == 0 && data == 1);     // not taken by the timed-out wait
+
+        for (uint32_t i = 0; i < MAX_FIFO_SIZE; i++)
+        {
+            CHECK(G8RTOS_WriteFIFO(CHECK_FIFO, i) == 0);
+        }
+        uint32_t start = SystemTime;
+        CHECK(G8RTOS_WriteFIFOTimeout(CHECK_FIFO, MAX_FIFO_SIZE, CHECK_TIMEOUT) == 1);
+        CHECK(SystemTime - start >= CHECK_TIMEOUT);
+        CHECK(G8RTOS_ReadFIFOTimeout(CHECK_FIFO, &data, 0) == 0 && data == 0);
+        CHECK(G8RTOS_WriteFIFOTimeout(CHECK_FIFO, MAX_FIFO_SIZE, 0) == 0);        // the freed slot was not taken either
+        for (uint32_t i = 1; i <= MAX_FIFO_SIZE; i++)
+        {
+            CHECK(G8RTOS_ReadFIFOTimeout(CHECK_FIFO, &data, 0) == 0 && data == (int32_t)i);
+        }
+    }
+
+    int32_t data;
+    CHECK(G8RTOS_WriteFIFO(MAX_FIFOS, 0) == 1);
+    CHECK(G8RTOS_WriteFIFOTimeout(MAX_FIFOS, 0, 0) == 1);
+    CHECK(G8RTOS_ReadFIFOTimeout(MAX_FIFOS, &data, 0) == 1);
+}
+
+static uint32_t poolStorage[G8RTOS_POOL_STORAGE_WORDS(sizeof(uint32_t), CHECK_POOL_BLOCKS)];
+
+/*
+ * Freeing a block twice is rejected and leaves the pool intact: every block is handed out exactly once afterwards
+ *  - Without POOL_DOUBLE_FREE_CHECK only a free while no block is allocated is caught
+ */
+static void CheckPoolDoubleFree(void)
+{
+    pool_t * pool = G8RTOS_PoolCreate(sizeof(uint32_t), CHECK_POOL_BLOCKS, poolStorage);
+    CHECK(pool != 0);
+    void * first = G8RTOS_PoolAlloc(pool);
+    void * second = G8RTOS_PoolAlloc(pool);
+    CHECK(G8RTOS_PoolFree(pool, first) == 0);
+#if POOL_DOUBLE_FREE_CHECK
+    CHECK(G8RTOS_PoolFree(pool, first) == 1);
+#endif
+    CHECK(G8RTOS_PoolFree(pool, second) == 0);
+    CHECK(G8RTOS_PoolFree(pool, second) == 1);
+
+    poolStats_t stats;
+    G8RTOS_PoolGetStats(pool, &stats);
+    CHECK(stats.usedBlocks == 0);
+
+    void * blocks[CHECK_POOL_BLOCKS + 1];
+    for (uint32_t i = 0; i <= CHECK_POOL_BLOCKS; i++)
+    {
+        blocks[i] = G8RTOS_PoolAlloc(pool);
+        for (uint32_t j = 0; j < i; j++)
+        {
+            CHECK(blocks[i] != blocks[j]);
+        }
+    }
+    CHECK(blocks[CHECK_POOL_BLOCKS] == 0);                          // no more blocks than the pool has
+}
+
+static eventGroup_t checkEvents;
+static uint32_t eventWaitBits;
+static uint8_t eventWaitOptions;
+static volatile uint32_t eventWaitResult;
+static volatile uint32_t eventWakeups;
+
+static void EventWaiterThread(void)
+{
+    eventWaitResult = G8RTOS_WaitEventBits(&checkEvents, eventWaitBits, eventWaitOptions);
+    eventWakeups++;
+    G8RTOS_KillSelf();
+}
+
+/*
+ * Starts a thread that waits once for bits with options, returns once it is blocked in G8RTOS_WaitEventBits
+ */
+static void StartEventWaiter(uint32_t bits, uint8_t options)
+{
+    eventWaitBits = bits;
+    eventWaitOptions = options;
+    eventWakeups = 0;
+    CHECK(G8RTOS_AddThread(EventWaiterThread, WAITER_PRIORITY, "waiter") == NO_ERROR);
+    G8RTOS_Sleep(1);
+    CHECK(eventWakeups == 0);
+}
+
+/*
+ * Sets bits, gives a woken waiter the time to run, returns the bits of the group afterwards
+ */
+static uint32_t SetEventBitsAndRun(uint32_t bits)
+{
+    G8RTOS_SetEventBits(&checkEvents, bits);
+    G8RTOS_Sleep(1);
+    return G8RTOS_GetEventBits(&checkEvents);
+}
+
+/*
+ * A blocked thread wakes once any or all of its bits are set, and clears the bits it waited for with EVENT_CLEAR_ON_EXIT
+ */
+static void CheckEventGroups(void)
+{
+    G8RTOS_InitEventGroup(&checkEvents);
+
+    StartEventWaiter(0x3, EVENT_WAIT_ANY);
+    CHECK(SetEventBitsAndRun(0x4) == 0x4);
+    CHECK(eventWakeups == 0);                                       // none of its bits
+    CHECK(SetEventBitsAndRun(0x2) == 0x6);
+    CHECK(eventWakeups == 1 && eventWaitResult == 0x6);             // any one bit is enough, nothing cleared
+
+    G8RTOS_ClearEventBits(&checkEvents, 0xFFFFFFFF);
+    StartEventWaiter(0x3, EVENT_WAIT_ALL | EVENT_CLEAR_ON_EXIT);
+    CHECK(SetEventBitsAndRun(0x9) == 0x9);
+    CHECK(eventWakeups == 0);                                       // only one of the two bits
+    CHECK(SetEventBitsAndRun(0x2) == 0x8);                          // only the bits waited for are cleared
+    CHECK(eventWakeups == 1 && eventWaitResult == 0xB);
+
+    G8RTOS_ClearEventBits(&checkEvents, 0xFFFFFFFF);
+    StartEventWaiter(0x3, EVENT_WAIT_ANY | EVENT_CLEAR_ON_EXIT);
+    CHECK(SetEventBitsAndRun(0x11) == 0x10);
+    CHECK(eventWakeups == 1 && eventWaitResult == 0x11);
+    CHECK(checkEvents.wait.waiters == 0);
+
+    G8RTOS_SetEventBits(&checkEvents, 0x1);
+    CHECK(G8RTOS_WaitEventBits(&checkEvents, 0x1, EVENT_WAIT_ALL | EVENT_CLEAR_ON_EXIT) == 0x11);   // already set, no block
+    CHECK(G8RTOS_GetEventBits(&checkEvents) == 0x10);
+}
+
+#if G8RTOS_IRQ_LATENCY
+static semaphore_t irqWake;
+
+static void IRQWakeHandler(void)
+{
+    G8RTOS_ReleaseSemaphore(&irqWake);
+}
+
+static void IRQVictimThread(void)
+{
+    G8RTOS_AcquireSemaphore(&irqWake);
+    while (1)
+    {
+        G8RTOS_Sleep(1000);
+    }
+}
+
+/*
+ * A thread woken by a measured interrupt and killed before it ran leaves no measurement behind: the next thread in its
+ * thread control block is not taken for it
+ */
+static void CheckIRQLatencyKilledThread(void)
+{
+    G8RTOS_InitSemaphore(&irqWake, 0);
+    CHECK(G8RTOS_AddThread(IRQVictimThread, PARKED_PRIORITY, "victim") == NO_ERROR);
+    threadId_t victim = CurrentlyRunningThread->next->threadID;
+    G8RTOS_Sleep(1);                                                // the victim blocks on irqWake
+    CHECK(G8RTOS_AddAPeriodicEvent(IRQWakeHandler, 1, PORT1_IRQn) == NO_ERROR);
+
+    G8RTOS_PortTriggerInterrupt(PORT1_IRQn);                        // wakes the victim, which is below the check thread
+    CHECK(G8RTOS_KillThread(victim) == NO_ERROR);
+    CHECK(G8RTOS_AddThread(ParkedThread, PARKED_PRIORITY, "reuse") == NO_ERROR);
+    CHECK((CurrentlyRunningThread->next->threadID & 0xFFFF) == (victim & 0xFFFF));
+    G8RTOS_Sleep(1);                                                // the new thread runs for the first time
+
+    irqLatencyStats_t stats;
+    CHECK(G8RTOS_GetIRQLatency(PORT1_IRQn, &stats, false) == 0);
+    CHECK(stats.samples == 0);
+    CHECK(G8RTOS_KillThread(CurrentlyRunningThread->next->threadID) == NO_ERROR);
+}
+#endif
+
+#if SCHED_POLICY == SCHED_POLICY_RM
+static mutex_t rmMutex;
+
+static void RMLockingJob(void)
+{
+    G8RTOS_LockMutex(&rmMutex);
+    G8RTOS_UnlockMutex(&rmMutex);
+}
+
+static void RMEmptyJob(void)
+{
+}
+
+/*
+ * A real-time thread moved to a lower rate-monotonic priority while it waits for a mutex must take the owner's inherited priority down with it
+ */
+static void CheckRateMonotonicInheritance(void)
+{
+    G8RTOS_InitMutex(&rmMutex);
+    G8RTOS_LockMutex(&rmMutex);
+    tcb_t * owner = G8RTOS_GetThread(G8RTOS_GetThreadID());
+
+    realTimeParams_t slow = { .wcet = 100, .period = 20 };
+    CHECK(G8RTOS_AddRealTimeThread(RMLockingJob, &slow, "rm slow") == NO_ERROR);
+    G8RTOS_Sleep(1);                            // its first job runs right away and blocks on the mutex
+    CHECK(owner->priority == REALTIME_PRIORITY);
+
+    realTimeParams_t fast = { .wcet = 100, .period = 10 };
+    CHECK(G8RTOS_AddRealTimeThread(RMEmptyJob, &fast, "rm fast") == NO_ERROR);
+    CHECK(owner->priority == REALTIME_PRIORITY + 1);     // the fast thread took REALTIME_PRIORITY, the waiter moved down one
+
+    G8RTOS_UnlockMutex(&rmMutex);
+    CHECK(owner->priority == CHECK_PRIORITY);
+}
+#endif
+
+static void CheckThread(void)
+{
+    CheckPeriodicReAdd();
+    CheckKernelThreadsKill();
+    CheckKilledThreadID();
+    CheckTimers();
+    CheckDeferredWork();
+    CheckSemaphoreTimeout();
+    CheckFIFOTimeout();
+    CheckPoolDoubleFree();
+    CheckEventGroups();
+#if G8RTOS_IRQ_LATENCY
+    CheckIRQLatencyKilledThread();
+#endif
+    failures += CheckCpp();
+#if SCHED_POLICY == SCHED_POLICY_RM
+    CheckRateMonotonicInheritance();
+#endif
+
+    printf("check: %s\n", failures ? "FAILED" : "ok");
+    fflush(stdout);
+    exit(failures ? 1 : 0);
+}
+
+int main(void)
+{
+    G8RTOS_Init();
+    G8RTOS_InitTimer(&staleTimer, CountingTimer, &staleRuns, 1, true);
+    G8RTOS_StartTimer(&staleTimer);
+    G8RTOS_InitWork(&staleWork, CountingWork, &staleRuns);
+    G8RTOS_Init();                              // starts over, the timer service and worker threads and the running timer are gone
+    if (G8RTOS_AddThread(CheckThread, CHECK_PRIORITY, "check") != NO_ERROR)
+    {
+        fprintf(stderr, "check: could not add the check thread\n");
+        return 1;
+    }
+    G8RTOS_Launch();
+    return 1;
+}
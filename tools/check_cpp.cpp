@@ -0,0 +1,135 @@
+/*
+ * check_cpp.cpp
+ *
+ * Host checks of the C++ layer (G8RTOS.hpp), built as C++11 and linked into the check program of tools/check.c
+ *      - CheckCpp runs inside the check thread and returns the number of failed checks
+ *      - Instantiates g8::Queue with a power of 2 and another capacity, g8::LockGuard and g8::Thread<>
+ */
+
+#include <stdio.h>
+#include "G8RTOS.hpp"
+
+#define CHECK_PRIORITY 10       // priority of the check thread in tools/check.c
+#define CPP_TIMEOUT 5           // milliseconds, timeout of the queue operations that are expected to time out
+#define CPP_MESSAGES 10         // messages of the send/receive round trip, more than either queue holds
+#define CPP_STOP 0xFFFFFFFF     // sequence number that stops the echo thread
+
+#define CHECK(condition) Check((condition), #condition, __LINE__)
+
+namespace
+{
+
+struct Message
+{
+    uint32_t sequence;
+    int16_t value;
+};
+
+uint32_t failures;
+
+g8::Queue<Message, 4> requests;         // power of 2, indices are masked
+g8::Queue<Message, 3> replies;          // indices wrap with a compare
+g8::Mutex echoMutex;
+uint32_t echoes;
+
+void Check(bool passed, const char * condition, int line)
+{
+    if (!passed)
+    {
+        printf("check_cpp.cpp:%d: failed: %s\n", line, condition);
+        failures++;
+    }
+}
+
+/*
+ * Sends every request back negated, counts them under echoMutex, stops at CPP_STOP
+ */
+void EchoThread()
+{
+    while (1)
+    {
+        Message message = { 0, 0 };
+        requests.receive(message);
+        if (message.sequence == CPP_STOP)
+        {
+            G8RTOS_KillSelf();
+        }
+        {
+            g8::LockGuard guard(echoMutex);
+            echoes++;
+        }
+        message.value = -message.value;
+        replies.send(message);
+    }
+}
+
+/*
+ * Fills a queue, checks that it is full and that a timed send gives up, then empties it in order and checks a timed
+ * receive gives up; repeated so the slot indices wrap around
+ */
+template <typename Q>
+void CheckQueueFillDrain(Q & queue, uint32_t rounds)
+{
+    uint32_t sequence = 0;
+    for (uint32_t round = 0; round < rounds; round++)
+    {
+        uint32_t first = sequence;
+        for (uint32_t i = 0; i < Q::capacity(); i++)
+        {
+            Message message = { sequence++, 0 };
+            CHECK(queue.trySend(message));
+        }
+        CHECK(queue.size() == Q::capacity());
+
+        Message extra = { sequence, 0 };
+        uint32_t start = SystemTime;
+        CHECK(!queue.trySend(extra));
+        CHECK(!queue.send(extra, CPP_TIMEOUT));
+        CHECK(SystemTime - start >= CPP_TIMEOUT);
+
+        for (uint32_t i = 0; i < Q::capacity(); i++)
+        {
+            Message message = { 0, 0 };
+            CHECK(queue.receive(message, 0) && message.sequence == first + i);
+        }
+        CHECK(queue.empty());
+
+        Message message = { 0, 0 };
+        start = SystemTime;
+        CHECK(!queue.tryReceive(message));
+        CHECK(!queue.receive(message, CPP_TIMEOUT));
+        CHECK(SystemTime - start >= CPP_TIMEOUT);
+    }
+}
+
+} // namespace
+
+extern "C" uint32_t CheckCpp(void)
+{
+    failures = 0;
+
+    CheckQueueFillDrain(requests, 3);
+    CheckQueueFillDrain(replies, 3);
+
+    CHECK(g8::Thread<>::stackWords == STACKSIZE);
+    CHECK(g8::Thread<MIN_STACKSIZE>::start(EchoThread, CHECK_PRIORITY + 1, "echo") == NO_ERROR);
+    uint32_t threads = G8RTOS_GetNumberOfThreads();
+
+    for (uint32_t i = 0; i < CPP_MESSAGES; i++)
+    {
+        Message request = { i, (int16_t)(i * 3) };
+        CHECK(requests.send(request, 10 * CPP_TIMEOUT));
+        Message reply = { 0, 0 };
+        CHECK(replies.receive(reply, 10 * CPP_TIMEOUT));
+        CHECK(reply.sequence == i && reply.value == -(int16_t)(i * 3));
+    }
+    CHECK(echoes == CPP_MESSAGES);
+    CHECK(echoMutex.native()->owner == 0);          // every guard unlocked on leaving its scope
+
+    Message stop = { CPP_STOP, 0 };
+    CHECK(requests.send(stop, 10 * CPP_TIMEOUT));
+    g8::this_thread::sleep(1);
+    CHECK(G8RTOS_GetNumberOfThreads() == threads - 1);
+
+    return failures;
+}
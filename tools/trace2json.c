@@ -0,0 +1,124 @@
+/*
+ * trace2json.c
+ *
+ * Host tool that turns a G8RTOS_TraceDump into Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+ *      - Build: cc -I.. -o trace2json trace2json.c
+ *      - Use: trace2json dump.bin > trace.json
+ *      - Every thread gets a track, with a slice for each time it ran (from context switches)
+ *      - Sleeps, semaphore and FIFO events are instant events on the thread's track, SysTicks are on their own track
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../G8RTOS_Trace.h"
+
+#define SYSTICK_TRACK 1000      // track id of the SysTick events, thread tracks use the thread control block index
+
+static const char * eventNames[] =
+{
+    [TRACE_CONTEXT_SWITCH]      = "switch",
+    [TRACE_SYSTICK]             = "SysTick",
+    [TRACE_SLEEP]               = "Sleep",
+    [TRACE_SEMAPHORE_ACQUIRE]   = "AcquireSemaphore",
+    [TRACE_SEMAPHORE_BLOCK]     = "AcquireSemaphore (blocked)",
+    [TRACE_SEMAPHORE_RELEASE]   = "ReleaseSemaphore",
+    [TRACE_FIFO_READ]           = "ReadFIFO",
+    [TRACE_FIFO_WRITE]          = "WriteFIFO",
+};
+
+static int ReadAll(FILE * in, void * data, size_t length)
+{
+    return fread(data, 1, length, in) == length;
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s dump.bin\n", argv[0]);
+        return 1;
+    }
+    FILE * in = fopen(argv[1], "rb");
+    if (!in)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    traceHeader_t header;
+    if (!ReadAll(in, &header, sizeof(header)) || header.magic != TRACE_MAGIC || header.cyclesPerSecond == 0)
+    {
+        fprintf(stderr, "%s: not a G8RTOS trace dump\n", argv[1]);
+        return 1;
+    }
+
+    traceThread_t * threads = calloc(header.threadCount + 1, sizeof(traceThread_t));
+    traceRecord_t * records = calloc(header.recordCount + 1, sizeof(traceRecord_t));
+    if (!threads || !records
+        || !ReadAll(in, threads, header.threadCount * sizeof(traceThread_t))
+        || !ReadAll(in, records, header.recordCount * sizeof(traceRecord_t)))
+    {
+        fprintf(stderr, "%s: truncated dump\n", argv[1]);
+        return 1;
+    }
+    fclose(in);
+
+    double usPerCycle = 1e6 / header.cyclesPerSecond;
+
+    printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    printf("{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"G8RTOS\"}}");
+    printf(",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"SysTick\"}}", SYSTICK_TRACK);
+    for (uint32_t i = 0; i < header.threadCount; i++)
+    {
+        printf(",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"%.*s\"}}",
+               (unsigned)(threads[i].threadID & 0xFF), TRACE_NAME_LENGTH, threads[i].name);
+    }
+
+    uint64_t time = 0;              // cycles since the first record, unwrapped
+    uint64_t sliceStart = 0;
+    int sliceThread = -1;           // thread running since sliceStart, -1 until the first context switch
+    for (uint32_t i = 0; i < header.recordCount; i++)
+    {
+        traceRecord_t * r = &records[i];
+        if (i > 0)
+        {
+            time += (uint32_t)(r->timestamp - records[i - 1].timestamp);
+        }
+        double us = time * usPerCycle;
+        const char * name = r->event < sizeof(eventNames) / sizeof(eventNames[0]) && eventNames[r->event]
+                            ? eventNames[r->event] : "unknown";
+
+        switch (r->event)
+        {
+        case TRACE_CONTEXT_SWITCH:
+            if (sliceThread < 0)
+            {
+                sliceThread = r->arg;   // the thread switched away from ran since the start of the trace
+            }
+            printf(",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"name\":\"running\",\"ts\":%.3f,\"dur\":%.3f}",
+                   sliceThread, sliceStart * usPerCycle, (time - sliceStart) * usPerCycle);
+            sliceThread = r->thread;
+            sliceStart = time;
+            break;
+        case TRACE_SYSTICK:
+            printf(",\n{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"name\":\"%s\",\"ts\":%.3f,\"args\":{\"time\":%u}}",
+                   SYSTICK_TRACK, name, us, r->arg);
+            break;
+        default:
+            printf(",\n{\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%u,\"name\":\"%s\",\"ts\":%.3f,\"args\":{\"arg\":%u}}",
+                   r->thread, name, us, r->arg);
+            break;
+        }
+    }
+    if (sliceThread >= 0)
+    {
+        printf(",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"name\":\"running\",\"ts\":%.3f,\"dur\":%.3f}",
+               sliceThread, sliceStart * usPerCycle, (time - sliceStart) * usPerCycle);
+    }
+    printf("\n]}\n");
+
+    free(threads);
+    free(records);
+    return 0;
+}